@@ -0,0 +1,88 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "asset_pack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+bool AssetPack::Open(const std::string& path)
+{
+    this->Close();
+    if (!this->file.Open(path))
+        return false;
+
+    // Validate the header and make sure the index and every blob lie inside the file.
+    const unsigned char* data = this->file.Data();
+    size_t size = this->file.Size();
+    const PackHeader* header = reinterpret_cast<const PackHeader*>(data);
+    if (size < sizeof(PackHeader) || std::memcmp(header->Magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header->Version != PACK_VERSION
+        || (size - sizeof(PackHeader)) / sizeof(PackEntry) < header->EntryCount)
+    {
+        std::cout << "ERROR::ASSET_PACK: " << path << " is not a valid asset pack" << std::endl;
+        this->Close();
+        return false;
+    }
+    const PackEntry* entries = reinterpret_cast<const PackEntry*>(data + sizeof(PackHeader));
+    for (uint32_t i = 0; i < header->EntryCount; ++i)
+    {
+        if (entries[i].Name[PACK_NAME_LENGTH - 1] != '\0' || entries[i].Offset > size || size - entries[i].Offset <= entries[i].Size)
+        {
+            std::cout << "ERROR::ASSET_PACK: " << path << " has a corrupt entry" << std::endl;
+            this->Close();
+            return false;
+        }
+    }
+
+    this->entries = entries;
+    this->entryCount = header->EntryCount;
+    return true;
+}
+
+void AssetPack::Close()
+{
+    this->file.Close();
+    this->entries = nullptr;
+    this->entryCount = 0;
+}
+
+bool AssetPack::Find(const std::string& name, AssetView& view) const
+{
+    // The packer writes the index sorted by name, so a binary search finds the entry.
+    uint32_t first = 0, last = this->entryCount;
+    while (first < last)
+    {
+        uint32_t middle = first + (last - first) / 2;
+        int order = std::strcmp(this->entries[middle].Name, name.c_str());
+        if (order == 0)
+        {
+            view.Data = this->file.Data() + this->entries[middle].Offset;
+            view.Size = static_cast<size_t>(this->entries[middle].Size);
+            return true;
+        }
+        if (order < 0)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return false;
+}
+
+void AssetPack::List(const std::string& prefix, std::vector<std::string>& names) const
+{
+    // Names sharing a prefix are adjacent in the sorted index.
+    const PackEntry* end = this->entries + this->entryCount;
+    const PackEntry* entry = std::lower_bound(this->entries, end, prefix,
+        [](const PackEntry& a, const std::string& name) { return std::strcmp(a.Name, name.c_str()) < 0; });
+    for (; entry != end && std::strncmp(entry->Name, prefix.c_str(), prefix.size()) == 0; ++entry)
+        names.push_back(entry->Name);
+}
@@ -17,13 +17,21 @@
 
 #include "game.h"
 #include "resource_manager.h"
+#include "render_state.h"
+#include "program_cache.h"
+#include "text_renderer.h"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 
 // --- Constants ---
 const unsigned int SCREEN_WIDTH = 800;  // Width of the application window.
 const unsigned int SCREEN_HEIGHT = 600; // Height of the application window.
+const char* const ASSET_PACK_FILE = "breakout.pak"; // Asset pack written by tools/pack_assets.
+const char* const PROGRAM_CACHE_DIRECTORY = "shader_cache"; // Linked program binaries from earlier runs.
+const double SIMULATION_STEP = 1.0 / 120.0; // Seconds of game time advanced by each simulation step.
+const double MAX_FRAME_TIME = 0.25;         // Longest frame caught up on; longer stalls (e.g. a dragged window) are skipped.
 
 // --- Global Variables ---
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT); // Game instance.
@@ -74,15 +82,34 @@ int main(int argc, char* argv[])
 
     // Configure OpenGL settings.
     glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderState::SetBlend(true);
+    RenderState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Use the asset pack next to the executable if there is one, so the game does not
+    // depend on the working directory; otherwise assets are read from ../shaders etc.
+    std::string executable = argc > 0 ? argv[0] : "";
+    size_t separator = executable.find_last_of("/\\");
+    std::string executableDirectory = separator == std::string::npos ? "" : executable.substr(0, separator + 1);
+    if (!ResourceManager::OpenPack(executableDirectory + ASSET_PACK_FILE))
+        ResourceManager::OpenPack(ASSET_PACK_FILE);
+
+    // Reuse shader program binaries and rasterized glyphs from earlier runs.
+    ProgramCache::Init(executableDirectory + PROGRAM_CACHE_DIRECTORY);
+    TextRenderer::SetCacheDirectory(executableDirectory);
+    if (Shader::InitParallelCompile())
+        std::cout << "| SHADER: parallel shader compilation enabled" << std::endl;
 
     // Initialize the game.
     Breakout.Init();
 
-    // Timing variables for frame management.
-    float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
+    // The simulation runs in fixed steps, so the game behaves the same at any frame rate.
+    // Frame time is measured in double precision and accumulated; each frame runs the steps
+    // that fit, and the remainder decides how far to blend between the last two steps.
+    double lastFrame = glfwGetTime();
+    double accumulator = 0.0;
+#ifdef BREAKOUT_RENDER_STATS
+    double lastStatsReport = lastFrame;  // Time of the last render state report
+#endif
 
     // Main game loop (frame).
     while (!glfwWindowShouldClose(window))
@@ -90,26 +117,40 @@ int main(int argc, char* argv[])
         // Code for troubleshooting frame issues
         /*auto start_time = std::chrono::high_resolution_clock::now();*/
 
-        // Calculate delta time (time elapsed between frames).
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
+        // Add the time elapsed since the last frame to the time still to simulate.
+        double currentFrame = glfwGetTime();
+        accumulator += std::min(currentFrame - lastFrame, MAX_FRAME_TIME);
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // Poll for input events (from the user).
-        Breakout.ProcessInput(deltaTime);
+        // Reload asset files edited since the last frame.
+        Breakout.HotReload();
 
-        // Update the game state.
-        Breakout.Update(deltaTime);
+        // Process input and update the game state in fixed steps.
+        while (accumulator >= SIMULATION_STEP)
+        {
+            Breakout.Step(static_cast<float>(SIMULATION_STEP));
+            accumulator -= SIMULATION_STEP;
+        }
 
         // Render the current frame.
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);  // Set background color to black.
         glClear(GL_COLOR_BUFFER_BIT);          // Clear the screen.
-        Breakout.Render();
+        Breakout.Render(static_cast<float>(accumulator / SIMULATION_STEP));
 
         // Swap the front and back buffers.
         glfwSwapBuffers(window);
 
+#ifdef BREAKOUT_RENDER_STATS
+        // Report how many GL state changes were issued and skipped over the last second.
+        if (currentFrame - lastStatsReport >= 1.0f) {
+            const RenderStateStats& stats = RenderState::Stats();
+            std::cout << "Render state: " << stats.Issued << " issued, " << stats.Elided << " elided" << std::endl;
+            RenderState::ResetStats();
+            lastStatsReport = currentFrame;
+        }
+#endif
+
         // Code for troubleshooting frame issues
         /*auto end_time = std::chrono::high_resolution_clock::now();
         std::chrono::duration<float> duration = end_time - start_time;
@@ -166,5 +207,6 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
+    Breakout.Resize(width, height);
 }
 
@@ -0,0 +1,205 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "file_watcher.h"
+
+#include <chrono>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// How long the background thread waits between checks; it also bounds how long Stop() blocks
+const int WATCH_INTERVAL_MILLISECONDS = 200;
+
+
+FileWatcher::~FileWatcher()
+{
+    this->Stop();
+}
+
+void FileWatcher::Stop()
+{
+    this->running = false;
+    if (this->thread.joinable())
+        this->thread.join();
+#ifdef __linux__
+    if (this->inotify >= 0)
+        close(this->inotify);
+    this->inotify = -1;
+    this->watches.clear();
+#else
+    this->modified.clear();
+#endif
+}
+
+std::vector<std::string> FileWatcher::Poll()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::vector<std::string> files(this->changed.begin(), this->changed.end());
+    this->changed.clear();
+    return files;
+}
+
+void FileWatcher::record(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->changed.insert(path);
+}
+
+#ifdef __linux__
+
+bool FileWatcher::Watch(const std::vector<std::string>& directories)
+{
+    this->Stop();
+    this->directories = directories;
+    this->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->inotify < 0)
+    {
+        std::cout << "ERROR::WATCH: inotify is not available" << std::endl;
+        return false;
+    }
+    // Editors either rewrite a file or write a temporary one and rename it over the original.
+    for (const std::string& directory : directories)
+    {
+        int watch = inotify_add_watch(this->inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch >= 0)
+            this->watches[watch] = directory;
+        else
+            std::cout << "ERROR::WATCH: cannot watch " << directory << std::endl;
+    }
+    if (this->watches.empty())
+    {
+        this->Stop();
+        return false;
+    }
+    this->running = true;
+    this->thread = std::thread(&FileWatcher::run, this);
+    return true;
+}
+
+void FileWatcher::run()
+{
+    alignas(inotify_event) char buffer[4096];
+    pollfd descriptor = { this->inotify, POLLIN, 0 };
+    while (this->running)
+    {
+        if (poll(&descriptor, 1, WATCH_INTERVAL_MILLISECONDS) <= 0)
+            continue;
+        ssize_t length;
+        while ((length = read(this->inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for (ssize_t offset = 0; offset < length; )
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+                auto directory = this->watches.find(event->wd);
+                if (event->len == 0 || (event->mask & IN_ISDIR) || directory == this->watches.end())
+                    continue;
+                this->record(directory->second + "/" + event->name);
+            }
+        }
+    }
+}
+
+#else
+
+// Returns the path and last write time of every file in a directory
+static std::vector<std::pair<std::string, unsigned long long>> listFiles(const std::string& directory)
+{
+    std::vector<std::pair<std::string, unsigned long long>> files;
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA((directory + "\\*").c_str(), &found);
+    if (search == INVALID_HANDLE_VALUE)
+        return files;
+    do
+    {
+        if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+        unsigned long long time = (static_cast<unsigned long long>(found.ftLastWriteTime.dwHighDateTime) << 32) | found.ftLastWriteTime.dwLowDateTime;
+        files.emplace_back(directory + "/" + found.cFileName, time);
+    } while (FindNextFileA(search, &found));
+    FindClose(search);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return files;
+    while (dirent* entry = readdir(dir))
+    {
+        std::string path = directory + "/" + entry->d_name;
+        struct stat status;
+        if (stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode))
+            files.emplace_back(path, static_cast<unsigned long long>(status.st_mtime));
+    }
+    closedir(dir);
+#endif
+    return files;
+}
+
+bool FileWatcher::Watch(const std::vector<std::string>& directories)
+{
+    this->Stop();
+    this->directories = directories;
+    // The first scan only records the current write times.
+    this->scan(false);
+    if (this->modified.empty())
+    {
+        std::cout << "ERROR::WATCH: no files to watch" << std::endl;
+        return false;
+    }
+    this->running = true;
+    this->thread = std::thread(&FileWatcher::run, this);
+    return true;
+}
+
+void FileWatcher::run()
+{
+    // Without a change notification API the directories are rescanned every few intervals.
+    const int intervalsPerScan = 3;
+    for (int interval = 1; this->running; ++interval)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_INTERVAL_MILLISECONDS));
+        if (interval % intervalsPerScan == 0)
+            this->scan(true);
+    }
+}
+
+void FileWatcher::scan(bool report)
+{
+    for (const std::string& directory : this->directories)
+    {
+        for (const auto& file : listFiles(directory))
+        {
+            auto known = this->modified.find(file.first);
+            if (known != this->modified.end() && known->second == file.second)
+                continue;
+            this->modified[file.first] = file.second;
+            if (report)
+                this->record(file.first);
+        }
+    }
+}
+
+#endif
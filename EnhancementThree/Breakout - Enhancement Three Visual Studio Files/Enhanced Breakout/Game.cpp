@@ -16,6 +16,9 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <future>
+#include <chrono>
+#include <cmath>
 
 #include "game.h"
 #include "resource_manager.h"
@@ -26,6 +29,10 @@
 #include <iostream>
 #include "text_renderer.h"
 #include "high_score_DB.h"
+#include "static_layer.h"
+#include "render_queue.h"
+#include "program_cache.h"
+#include "file_watcher.h"
 
 // --- Global Variables ---
 // Game-related render objects.
@@ -34,13 +41,22 @@ GameObject* Player;                  // Player's paddle object
 BallObject* Ball;                    // Ball object
 ParticleGenerator* Particles;        // Particle generator for ball effects
 TextRenderer* Text;                  // Text renderer for displaying text
+TileMapRenderer* Tiles;              // Tile map renderer for drawing whole brick grids
+StaticLayer* Backdrop;               // Cached background and solid bricks of the current level
+RenderQueue* Queue;                  // Sorts the frame's draws by pass, shader and texture
+FileWatcher* Watcher;                // Reports edited asset files; only used when assets are not packed
+
+// Depth of the blended layers; lower layers are drawn first
+const unsigned int LAYER_PARTICLES = 0;
+const unsigned int LAYER_SPRITES = 1;
+const unsigned int LAYER_TEXT = 2;
 HighScoreDB* db;                     // Database handler for high scores
 
 // --- Game Class Implementation ---
 
 // Constructor: Initializes game state, width, height, and other variables.
 Game::Game(unsigned int width, unsigned int height)
-    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3), levelCompletionTime()
+    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), FramebufferWidth(width), FramebufferHeight(height), Level(0), Lives(3), levelCompletionTime()
 {
 
 }
@@ -53,77 +69,102 @@ Game::~Game()
     delete Ball;
     delete Particles;
     delete Text;
+    delete Tiles;
+    delete Backdrop;
+    delete Queue;
+    delete Watcher;
     delete db;
 }
 
 // Initializes all the game objects, resources, shaders, and levels.
 void Game::Init()
 {   
+    auto initStart = std::chrono::high_resolution_clock::now();
+
+    // --- Start Decoding Assets ---
+    // Image decoding and font rasterization only touch their own data,
+    // so they run on worker threads while the shaders are compiled below. Only the
+    // GL uploads and the ResourceManager updates happen here, on the GL thread.
+    auto decode = [](const char* file, int channels) {
+        return std::async(std::launch::async, ResourceManager::DecodeImage, std::string(file), channels);
+    };
+    std::future<DecodedImage> background = decode("../textures/background.jpg", 0);
+    std::future<DecodedImage> textBox = decode("../textures/text_box.png", 0);
+    std::vector<std::pair<std::future<DecodedImage>, std::string>> sprites;
+    sprites.emplace_back(decode("../textures/teal_ball.png", 4), "face");
+    sprites.emplace_back(decode("../textures/block.png", 4), "block");
+    sprites.emplace_back(decode("../textures/block_solid.png", 4), "block_solid");
+    sprites.emplace_back(decode("../textures/paddle.png", 4), "paddle");
+    sprites.emplace_back(decode("../textures/teal-particle.png", 4), "particle");
+
+    auto fontStart = std::chrono::high_resolution_clock::now();
+    std::future<FontAtlas> font = std::async(std::launch::async, TextRenderer::Rasterize, std::string("../fonts/ARJULIAN.TTF"), 24u);
+
     // --- Load Shaders ---
-    // Load vertex and fragment shaders for sprite rendering and particles.
-    ResourceManager::LoadShader("../shaders/sprite.vs", "../shaders/sprite.fs", nullptr, "sprite");
-    ResourceManager::LoadShader("../shaders/particle.vs", "../shaders/particle.fs", nullptr, "particle");
+    // Submit the shaders for sprite rendering and particles; the driver compiles them
+    // while the textures are uploaded below.
+    ResourceManager::SubmitShader("../shaders/sprite.vs", "../shaders/sprite.fs", nullptr, "sprite");
+    ResourceManager::SubmitShader("../shaders/particle.vs", "../shaders/particle.fs", nullptr, "particle");
+    ResourceManager::SubmitShader("../shaders/sprite_batch.vs", "../shaders/sprite_batch.fs", nullptr, "sprite_batch");
+    ResourceManager::SubmitShader("../shaders/tilemap.vs", "../shaders/tilemap.fs", nullptr, "tilemap");
+
+    // --- Load Textures ---
+    // Upload the decoded textures (e.g., background, text box) as they become available.
+    ResourceManager::LoadTexture(background.get(), false, "background");
+    ResourceManager::LoadTexture(textBox.get(), true, "text_box");
+
+    // Pack the small sprites into one atlas so bricks, paddle, ball and particles share a texture.
+    std::vector<std::pair<DecodedImage, std::string>> spriteImages;
+    for (auto& sprite : sprites)
+        spriteImages.emplace_back(sprite.first.get(), sprite.second);
+    ResourceManager::LoadAtlas(spriteImages, "sprites");
 
     // --- Configure shaders ---
+    // The renderers resolve their uniform locations on construction, so the programs must have linked.
+    ResourceManager::FinishShaders();
+
     // Set up orthographic projection matrix for 2D rendering.
     glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width),
         static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
 
-    // Apply projection matrix to shaders.
+    // Upload the projection matrix once into the uniform block shared by all shaders.
+    Shader::UpdateFrameUniforms(projection);
     ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
+    ResourceManager::GetShader("sprite_batch").Use().SetInteger("image", 0);
     ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
-
-    // --- Load Textures ---
-    // Load various textures used in the game (e.g., ball, paddle, background).
-    ResourceManager::LoadTexture("../textures/teal_ball.png", true, "face");
-    ResourceManager::LoadTexture("../textures/background.jpg", false, "background");
-    ResourceManager::LoadTexture("../textures/text_box.png", true, "text_box");
-    ResourceManager::LoadTexture("../textures/block.png", false, "block");
-    ResourceManager::LoadTexture("../textures/block_solid.png", false, "block_solid");
-    ResourceManager::LoadTexture("../textures/paddle.png", true, "paddle");
-    ResourceManager::LoadTexture("../textures/teal-particle.png", true, "particle");
 
     // --- Initialize Renderers ---
     // Initialize renderers for sprites, particles, and text.
-    Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
+    Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"), ResourceManager::GetShader("sprite_batch"));
     Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 750);
-    Text = new TextRenderer(this->Width, this->Height);
+    Text = new TextRenderer();
+    Tiles = new TileMapRenderer(ResourceManager::GetShader("tilemap"), ResourceManager::GetTexture("block"), ResourceManager::GetTexture("block_solid"));
+
+    // The tile map shader tints bricks with the same colors GameLevel assigns them.
+    glm::vec3 tileColors[TILE_COLOR_COUNT];
+    for (unsigned int code = 0; code < TILE_COLOR_COUNT; ++code)
+        tileColors[code] = GameLevel::TileColor(code);
+    Tiles->SetPalette(tileColors);
+    Backdrop = new StaticLayer();
+    Queue = new RenderQueue();
 
     // Load font for text rendering.
-    Text->Load("../fonts/ARJULIAN.TTF", 24);
+    Text->Load(font.get());
+    std::chrono::duration<double, std::milli> fontTime = std::chrono::high_resolution_clock::now() - fontStart;
+    std::cout << "| LOAD: font ARJULIAN.TTF: " << fontTime.count() << " ms" << std::endl;
 
     // --- Load Levels ---
-    // Load level data from files and initialize levels.
-    GameLevel one; one.Load("../levels/1.lvl", this->Width, this->Height / 2);
-    GameLevel two; two.Load("../levels/2.lvl", this->Width, this->Height / 2);
-    GameLevel three; three.Load("../levels/3.lvl", this->Width, this->Height / 2);
-    GameLevel four; four.Load("../levels/4.lvl", this->Width, this->Height / 2);
-    GameLevel five; five.Load("../levels/5.lvl", this->Width, this->Height / 2);
-    GameLevel six; six.Load("../levels/6.lvl", this->Width, this->Height / 2);
-
-    // Add levels to the levels container.
-    this->Levels.push_back(one);
-    this->Levels.push_back(two);
-    this->Levels.push_back(three);
-    this->Levels.push_back(four);
-    this->Levels.push_back(five);
-    this->Levels.push_back(six);
-
-    // Create/Open the high score database.
+    // List the levels; only the first one is loaded now, and its neighbours in the menu
+    // are parsed in the background. The rest are loaded when they are selected.
+    auto levelStart = std::chrono::high_resolution_clock::now();
+    this->Levels.Scan("../levels", this->Width, this->Height / 2);
+    this->Levels.Select(this->Level);
+    std::chrono::duration<double, std::milli> levelTime = std::chrono::high_resolution_clock::now() - levelStart;
+    std::cout << "| LOAD: " << this->Levels.Size() << " levels listed, first loaded in " << levelTime.count() << " ms" << std::endl;
+
+    // Create/Open the high score database. A level's table is created the first time it is used.
     db = new HighScoreDB("highscores.db");
 
-
-
-
-    // Create tables for each level (if they don't already exist).
-    for (int level = 0; level < 6; ++level) {
-        if (!db->createTable(level)) {
-            std::cerr << "Failed to create table for level " << level << "." << std::endl;
-        }
-    }
-
     // --- Configure Game Objects ---
     // Set initial player position and ball position.
     glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
@@ -132,14 +173,36 @@ void Game::Init()
     // Create player paddle and ball objects.
     Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
     Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+    this->previousPlayerPosition = playerPos;
+    this->previousBallPosition = ballPos;
+
+    // --- Watch Assets ---
+    // Assets read from the file system are reloaded when they are edited, keeping the running game.
+    if (!ResourceManager::IsPackOpen())
+    {
+        Watcher = new FileWatcher();
+        if (Watcher->Watch({ "../shaders", "../textures", "../levels" }))
+            std::cout << "| LOAD: watching shaders, textures and levels for changes" << std::endl;
+    }
+
+    std::chrono::duration<double, std::milli> initTime = std::chrono::high_resolution_clock::now() - initStart;
+    ProgramCache::Report();
+    std::cout << "| LOAD: Game::Init total: " << initTime.count() << " ms" << std::endl;
 }
 
 // Update the game state, handling ball movement, collisions, particle updates, 
 // loss condition, win condition, and high score checks.
 void Game::Update(float dt)
 {
-    Ball->Move(dt, this->Width);  // Update ball position based on delta time.
-    this->DoCollisions();         // Check for collisions (ball, paddle, and bricks).
+    if (COLLISION_MODE == COLLISION_CONTINUOUS)
+    {
+        this->sweepBall(dt);          // Move the ball, resolving each contact when it happens.
+    }
+    else
+    {
+        Ball->Move(dt, this->Width);  // Update ball position based on delta time.
+        this->DoCollisions();         // Check for collisions (ball, paddle, and bricks).
+    }
     Particles->Update(dt, *Ball,1, glm::vec2(Ball->Radius / 2.0f));  // Update particles.
 
     // Check for loss condition (ball fell below screen).
@@ -162,7 +225,7 @@ void Game::Update(float dt)
         StopLevelTimer();
 
         // Check if the player has achieved a high score for the current level.
-        if (!db->isNewHighScore(this->Level, levelCompletionTime))
+        if (!db->isNewHighScore(this->scoreTable(), levelCompletionTime))
         {
             // Set the game state to "GAME_WIN" if the player wins, 
             // but doesn't set a high score.
@@ -177,6 +240,34 @@ void Game::Update(float dt)
 }
 
 
+// Remembers where the paddle and ball were, so frames drawn before the next step can blend towards the new positions.
+void Game::Step(float dt)
+{
+    this->previousPlayerPosition = Player->Position;
+    this->previousBallPosition = Ball->Position;
+    this->ProcessInput(dt);
+    this->Update(dt);
+}
+
+// Drains the file watcher and reloads what each changed file was loaded into.
+// Cached renderings are redrawn, since the background or a brick image may have changed.
+void Game::HotReload()
+{
+    if (!Watcher)
+        return;
+    bool reloaded = false;
+    for (const std::string& file : Watcher->Poll())
+    {
+        if (ResourceManager::Reload(file) || this->Levels.FileChanged(file))
+            reloaded = true;
+    }
+    // A new level file listed before the current level shifts its index.
+    this->Level = static_cast<unsigned int>(this->Levels.Selected());
+    if (reloaded)
+        Backdrop->Invalidate();
+}
+
+
 // Handle character input for entering the player's name in the high score screen.
  void Game::ProcessCharInput(char c)
 {
@@ -198,22 +289,26 @@ void Game::ProcessInput(float dt)
 {
     if (this->State == GAME_MENU)
     {
-        // If ENTER is pressed, start the game.
-        if (this->Keys[GLFW_KEY_ENTER] && !this->KeysProcessed[GLFW_KEY_ENTER])
+        // If ENTER is pressed, start the game. A level that failed to load has no bricks to clear.
+        if (this->Keys[GLFW_KEY_ENTER] && !this->KeysProcessed[GLFW_KEY_ENTER] && this->Levels.Size() > 0)
         {
-            this->State = GAME_ACTIVE;
+            if (this->Levels[this->Level].IsPlayable())
+                this->State = GAME_ACTIVE;
+            else
+                std::cout << "ERROR::LEVEL: level " << this->Levels.Number(this->Level) << " has no breakable bricks" << std::endl;
             this->KeysProcessed[GLFW_KEY_ENTER] = true;  // Mark ENTER as processed.
         }
 
         // If W is pressed, move to the next level
-        if (this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W])
+        if (this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W] && this->Levels.Size() > 0)
         {
-            this->Level = (this->Level + 1) % 6;     // Cycle through levels (0-5).
+            this->Level = (this->Level + 1) % this->Levels.Size();  // Cycle through the levels.
+            this->Levels.Select(this->Level);
             this->KeysProcessed[GLFW_KEY_W] = true;  // Mark W as processed.
         }
 
         // If S is pressed, move to the previous level.
-        if (this->Keys[GLFW_KEY_S] && !this->KeysProcessed[GLFW_KEY_S])
+        if (this->Keys[GLFW_KEY_S] && !this->KeysProcessed[GLFW_KEY_S] && this->Levels.Size() > 0)
         {
             if (this->Level > 0)
             {
@@ -221,8 +316,9 @@ void Game::ProcessInput(float dt)
             }
             else
             {
-                this->Level = 5;  // Wrap around to the last level.
+                this->Level = static_cast<unsigned int>(this->Levels.Size() - 1);  // Wrap around to the last level.
             }
+            this->Levels.Select(this->Level);
             this->KeysProcessed[GLFW_KEY_S] = true;   // Mark S as processed.
         }
 
@@ -258,7 +354,7 @@ void Game::ProcessInput(float dt)
         if (this->Keys[GLFW_KEY_ENTER] && !this->playerName.empty())
         {
 
-            db->addScore(this->Level, this->playerName, this->levelCompletionTime);
+            db->addScore(this->scoreTable(), this->playerName, this->levelCompletionTime);
 
             // Reset name input, reset level, and proceed to high score display screen.
             this->KeysProcessed[GLFW_KEY_ENTER] = true;
@@ -334,34 +430,62 @@ void Game::ProcessInput(float dt)
     }
 }
 
-void Game::Render()
+void Game::Render(float alpha)
 {
+    // Age the text layout cache so strings that are no longer shown get released.
+    Text->NewFrame();
+
     // If the game is active, in the menu, or the win state, render the game elements.
     if (this->State == GAME_ACTIVE || this->State == GAME_MENU || this->State == GAME_WIN)
     {
-        // Draw the background texture at full screen size.
-        Renderer->DrawSprite(ResourceManager::GetTexture("background"), 
-            glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
-
-        // Draw the current level.
-        this->Levels[this->Level].Draw(*Renderer);  
-
-        // Draw the player's paddle.
-        Player->Draw(*Renderer);
+        // The background and the solid bricks never change during a level, so they are
+        // rendered once into the backdrop layer, which is rebuilt whenever the level is
+        // (re)loaded or the framebuffer is resized.
+        const GameLevel& level = this->Levels[this->Level];
+        if (!Backdrop->IsCurrent(level.Generation, this->FramebufferWidth, this->FramebufferHeight))
+        {
+            Backdrop->Begin(level.Generation, this->FramebufferWidth, this->FramebufferHeight);
+            Renderer->DrawSprite(ResourceManager::GetTexture("background"),
+                glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
+            this->drawBricks(BRICKS_SOLID);
+            Backdrop->End();
+        }
+        Backdrop->Blit();
+
+        // Queue the rest of the scene; the queue sorts it into an opaque pass and the blended passes.
+        unsigned int spriteBatchShader = ResourceManager::GetShader("sprite_batch").ID;
+        unsigned int sprites = ResourceManager::GetTexture("sprites").ID;
+
+        // The bricks that can still be destroyed are opaque and never overlap.
+        unsigned int brickShader = LEVEL_RENDER_MODE == LEVEL_RENDER_TILE_MAP ? ResourceManager::GetShader("tilemap").ID : spriteBatchShader;
+        Queue->Submit(RENDER_PASS_OPAQUE, 0, brickShader, sprites, [this]() { this->drawBricks(BRICKS_BREAKABLE); });
+
+        // The player's paddle and the ball, between their positions of the last two simulation steps.
+        // Both are regions of the sprite atlas, so one batch draws them with a single instanced call.
+        glm::vec2 playerPosition = glm::mix(this->previousPlayerPosition, Player->Position, alpha);
+        glm::vec2 ballPosition = glm::mix(this->previousBallPosition, Ball->Position, alpha);
+        Queue->Submit(RENDER_PASS_ALPHA, LAYER_SPRITES, spriteBatchShader, sprites, [playerPosition, ballPosition]() {
+            Renderer->Begin();
+            Renderer->DrawSprite(Player->Sprite, playerPosition, Player->Size, Player->Rotation, Player->Color);
+            Renderer->DrawSprite(Ball->Sprite, ballPosition, Ball->Size, Ball->Rotation, Ball->Color);
+            Renderer->End();
+        });
 
         // Draw particle effects while ball is in motion.
         if ((Ball->Stuck && Player->Velocity.x != 0) || !Ball->Stuck)
-        Particles->Draw();
-
-        // Draw the ball.
-        Ball->Draw(*Renderer);
+            Queue->Submit(RENDER_PASS_ADDITIVE, LAYER_PARTICLES, ResourceManager::GetShader("particle").ID, sprites, []() { Particles->Draw(); });
 
         // If the game is active, display the player's remaining lives.
         if (this->State == GAME_ACTIVE) {
             std::stringstream ss;
             ss << this->Lives;   // Convert lives count to string.
-            Text->RenderText("Lives: " + ss.str(), 5.0f, 5.0f, 1.0f, glm::vec3(1.0f, 0.9f, 0.9f));
+            std::string lives = "Lives: " + ss.str();
+            Queue->Submit(RENDER_PASS_ALPHA, LAYER_TEXT, ResourceManager::GetShader("text").ID, Text->AtlasTexture,
+                [lives]() { Text->RenderText(lives, 5.0f, 5.0f, 1.0f, glm::vec3(1.0f, 0.9f, 0.9f)); });
         }
+
+        // Draw the queued scene; the menus and overlays below are drawn on top of it.
+        Queue->Execute();
     }
 
     // If the game is in the menu state, render menu instructions and options.
@@ -427,7 +551,7 @@ void Game::Render()
         Text->RenderCenteredText("HIGH SCORES", 70.0f, Width, 1.5f, glm::vec3(0.1f, 0.9f, 0.2f));
 
         // Retrieve the high scores for the current level.
-        std::vector<HighScore> highScores = db->getHighScores(this->Level);
+        std::vector<HighScore> highScores = db->getHighScores(this->scoreTable());
 
         // Define column positions for displaying high score information.
         float rankX = 220.0f;
@@ -470,10 +594,10 @@ void Game::Render()
 // --- Collision Handling Helper Function Declarations ---
 
 // Checks for AABB-AABB (Axis-Aligned Bounding Box) collision.
-bool CheckCollision(GameObject& one, GameObject& two);
+bool CheckCollision(const GameObject& one, const GameObject& two);
 
 // Checks for AABB-Circle collision and returns collision data (collision occurred, direction, and difference vector).
-Collision CheckCollision(BallObject& one, GameObject& two);
+Collision CheckCollision(const BallObject& one, const GameObject& two);
 
 // Determines the closest cardinal direction (UP, DOWN, LEFT, RIGHT) based on a given vector.
 Direction VectorDirection(glm::vec2 closest);
@@ -484,22 +608,54 @@ void ResolveBrickCollision(BallObject& ball, Direction dir, const glm::vec2& dif
 // Handles ball-paddle collision resolution by adjusting velocity based on impact position.
 void ResolvePaddleCollision(const Collision& collision);
 
+// Finds when a ball moving by motion first touches an AABB, given by its top-left corner and size,
+// as a fraction of the motion. Only contacts earlier than time are reported; time and normal then receive the contact.
+bool SweepCollision(BallObject& ball, glm::vec2 motion, glm::vec2 position, glm::vec2 size, float& time, glm::vec2& normal);
+
+// Draws a subset of the current level's bricks.
+void Game::drawBricks(BrickSet bricks)
+{
+    if (LEVEL_RENDER_MODE == LEVEL_RENDER_TILE_MAP)
+        this->Levels[this->Level].Draw(*Tiles, bricks);
+    else
+        this->Levels[this->Level].Draw(*Renderer, bricks);
+}
+
+// Levels keep the table of their file number (level "3.lvl" uses table 2), so adding or
+// removing level files does not move existing high scores to another level.
+int Game::scoreTable() const
+{
+    return this->Level < this->Levels.Size() ? static_cast<int>(this->Levels.Number(this->Level)) - 1 : 0;
+}
+
+// Stores the framebuffer size used to size cached layers.
+void Game::Resize(unsigned int width, unsigned int height)
+{
+    // Minimized windows report a zero size; keep the last real one.
+    if (width == 0 || height == 0)
+        return;
+    this->FramebufferWidth = width;
+    this->FramebufferHeight = height;
+}
+
 // --- Collision Handling ---
 
 // Handles all collision detection and resolution for the game.
 void Game::DoCollisions()
 {
-    // Check for collisions between ball and bricks
-    for (GameObject& box : this->Levels[this->Level].Bricks)
+    // Check for collisions between ball and bricks; only the bricks in the cells under the ball can touch it.
+    GameLevel& level = this->Levels[this->Level];
+    level.QueryBricks(Ball->Position, Ball->Position + glm::vec2(Ball->Radius * 2.0f), this->nearbyBricks);
+    for (size_t i : this->nearbyBricks)
     {
-        if (!box.Destroyed)
+        if (!level.IsDestroyed(i))
         {
-            Collision collision = CheckCollision(*Ball, box);
+            Collision collision = CheckCollision(*Ball, level.Brick(i));
             if (std::get<0>(collision)) // If collsion occurred
             {
                 // Destroy brick if not solid
-                if (!box.IsSolid)
-                    box.Destroyed = true;
+                if (!level.IsSolid(i))
+                    level.DestroyBrick(i);
 
                 // Resolve collision by adjusting ball velocity and position.
                 Direction dir = std::get<1>(collision);
@@ -520,15 +676,90 @@ void Game::DoCollisions()
     }
 }
 
-// Resets the bricks for the current level.
+// Sweeps the ball along its motion and stops at the earliest contact with a wall, brick or the paddle.
+// After resolving that contact the rest of the motion continues from the contact point, so fast
+// balls cannot pass through bricks and two bricks hit in one step bounce the ball only once.
+void Game::sweepBall(float dt)
+{
+    if (Ball->Stuck)
+        return;
+
+    GameLevel& level = this->Levels[this->Level];
+    float remaining = dt;
+    for (unsigned int contact = 0; contact < MAX_BALL_CONTACTS && remaining > 0.0f; ++contact)
+    {
+        glm::vec2 center = Ball->Position + Ball->Radius;
+        glm::vec2 motion = Ball->Velocity * remaining;
+        float time = 1.0f;
+        glm::vec2 normal(0.0f);
+        enum { HIT_NONE, HIT_WALL, HIT_BRICK, HIT_PADDLE } hit = HIT_NONE;
+        size_t brick = 0;
+
+        // Side and top walls; the bottom is open.
+        if (motion.x < 0.0f && (Ball->Radius - center.x) / motion.x < time)
+        {
+            time = std::max((Ball->Radius - center.x) / motion.x, 0.0f);
+            normal = glm::vec2(1.0f, 0.0f);
+            hit = HIT_WALL;
+        }
+        if (motion.x > 0.0f && (this->Width - Ball->Radius - center.x) / motion.x < time)
+        {
+            time = std::max((this->Width - Ball->Radius - center.x) / motion.x, 0.0f);
+            normal = glm::vec2(-1.0f, 0.0f);
+            hit = HIT_WALL;
+        }
+        if (motion.y < 0.0f && (Ball->Radius - center.y) / motion.y < time)
+        {
+            time = std::max((Ball->Radius - center.y) / motion.y, 0.0f);
+            normal = glm::vec2(0.0f, 1.0f);
+            hit = HIT_WALL;
+        }
+
+        // Bricks in the cells the ball passes through.
+        glm::vec2 pathMin = glm::min(center, center + motion) - Ball->Radius;
+        glm::vec2 pathMax = glm::max(center, center + motion) + Ball->Radius;
+        level.QueryBricks(pathMin, pathMax, this->nearbyBricks);
+        for (size_t i : this->nearbyBricks)
+        {
+            if (!level.IsDestroyed(i) && SweepCollision(*Ball, motion, level.BrickPositions[i], level.BrickSize, time, normal))
+            {
+                hit = HIT_BRICK;
+                brick = i;
+            }
+        }
+        if (SweepCollision(*Ball, motion, Player->Position, Player->Size, time, normal))
+        {
+            hit = HIT_PADDLE;
+        }
+
+        // Advance to the contact, or through the whole step if there is none.
+        Ball->Position += motion * time;
+        remaining -= remaining * time;
+        if (hit == HIT_NONE)
+            break;
+
+        if (hit == HIT_PADDLE)
+        {
+            ResolvePaddleCollision(std::make_tuple(true, UP, normal));
+            continue;
+        }
+        if (hit == HIT_BRICK && !level.IsSolid(brick))
+        {
+            level.DestroyBrick(brick);
+        }
+        // Reflect the velocity about the contact normal: an axis flip on faces, a glancing bounce on corners.
+        Ball->Velocity -= 2.0f * glm::dot(Ball->Velocity, normal) * normal;
+    }
+}
+
+// Resets the bricks for the current level from the state kept when it was loaded.
 void Game::ResetLevel()
 {
-    std::string fileName = "../levels/" + std::to_string(this->Level + 1) + ".lvl";
-    this->Levels[this->Level].Load(fileName, this->Width, this->Height / 2);
+    this->Levels[this->Level].Reset();
 }
 
 // Resets the player paddle and ball to their starting positions.
-void Game::ResetPlayer() const
+void Game::ResetPlayer()
 {
     Player->Size = PLAYER_SIZE;
     Player->Velocity.x = 0.0f;
@@ -541,6 +772,10 @@ void Game::ResetPlayer() const
 
     // Reset ball position and velocity.
     Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+
+    // Jump straight to the new positions instead of blending towards them.
+    this->previousPlayerPosition = Player->Position;
+    this->previousBallPosition = Ball->Position;
 }
 
 // Starts the level completion timer.
@@ -562,7 +797,7 @@ float Game::GetLevelCompletionTime() const {
 // --- Helper Functions ---
 
 // Performs AABB-AABB collision detection between two game objects.
-bool CheckCollision(GameObject& one, GameObject& two)
+bool CheckCollision(const GameObject& one, const GameObject& two)
 {
     // Check collision along the x-axis.
     bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
@@ -577,7 +812,7 @@ bool CheckCollision(GameObject& one, GameObject& two)
 }
 
 // Performs AABB-Circle collision detection and returns the collision data.
-Collision CheckCollision(BallObject& one, GameObject& two)
+Collision CheckCollision(const BallObject& one, const GameObject& two)
 {
     // Calculate the center of the ball.
     glm::vec2 center(one.Position + one.Radius);
@@ -608,6 +843,84 @@ Collision CheckCollision(BallObject& one, GameObject& two)
         return std::make_tuple(false, UP, glm::vec2(0.0f, 0.0f));
 }
 
+// Sweeps the ball against the box grown by its radius (a rounded rectangle): the flat sides
+// are found with a slab test, and a path entering near a corner is tested against the corner's circle.
+bool SweepCollision(BallObject& ball, glm::vec2 motion, glm::vec2 position, glm::vec2 size, float& time, glm::vec2& normal)
+{
+    glm::vec2 center(ball.Position + ball.Radius);
+    float radius = ball.Radius;
+    glm::vec2 boxMin = position;
+    glm::vec2 boxMax = position + size;
+    if (motion == glm::vec2(0.0f))
+        return false;
+
+    // A ball that already overlaps the box touches it now, unless it is on its way out.
+    glm::vec2 offset = center - glm::clamp(center, boxMin, boxMax);
+    float distanceSquared = glm::dot(offset, offset);
+    if (distanceSquared < radius * radius)
+    {
+        glm::vec2 outward = distanceSquared > 0.0f ? offset / std::sqrt(distanceSquared) : -glm::normalize(motion);
+        if (glm::dot(motion, outward) >= 0.0f)
+            return false;
+        time = 0.0f;
+        normal = outward;
+        return true;
+    }
+
+    // Slab test against the grown box; axis is the side the path enters through.
+    glm::vec2 grownMin = boxMin - radius;
+    glm::vec2 grownMax = boxMax + radius;
+    float enter = 0.0f, exit = time;
+    int axis = -1;
+    for (int i = 0; i < 2; ++i)
+    {
+        if (motion[i] == 0.0f)
+        {
+            if (center[i] < grownMin[i] || center[i] > grownMax[i])
+                return false;
+            continue;
+        }
+        float slabEnter = (grownMin[i] - center[i]) / motion[i];
+        float slabExit = (grownMax[i] - center[i]) / motion[i];
+        if (slabEnter > slabExit)
+            std::swap(slabEnter, slabExit);
+        if (slabEnter > enter)
+        {
+            enter = slabEnter;
+            axis = i;
+        }
+        exit = std::min(exit, slabExit);
+        if (enter > exit || enter >= time)
+            return false;
+    }
+
+    // Entering through a flat side.
+    glm::vec2 point = center + motion * enter;
+    if (axis >= 0 && point[1 - axis] >= boxMin[1 - axis] && point[1 - axis] <= boxMax[1 - axis])
+    {
+        normal = glm::vec2(0.0f);
+        normal[axis] = motion[axis] > 0.0f ? -1.0f : 1.0f;
+        time = enter;
+        return true;
+    }
+
+    // Entering near a corner: the ball touches the box where its center reaches the corner's circle.
+    glm::vec2 corner = glm::clamp(point, boxMin, boxMax);
+    glm::vec2 fromCorner = center - corner;
+    float a = glm::dot(motion, motion);
+    float b = glm::dot(fromCorner, motion);
+    float c = glm::dot(fromCorner, fromCorner) - radius * radius;
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f)
+        return false;
+    float contact = (-b - std::sqrt(discriminant)) / a;
+    if (contact < 0.0f || contact >= time)
+        return false;
+    time = contact;
+    normal = glm::normalize(center + motion * contact - corner);
+    return true;
+}
+
 // Determines the closest cardinal direction (UP, DOWN, LEFT, RIGHT) for a given vector.
 Direction VectorDirection(glm::vec2 target)
 {
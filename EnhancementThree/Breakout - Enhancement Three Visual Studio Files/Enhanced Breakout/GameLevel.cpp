@@ -9,122 +9,446 @@
 
 
 #include "game_level.h"
+#include "render_state.h"
+#include "level_file.h"
+#include "mapped_file.h"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <iostream>
 #include <sstream>
 
+#include <sys/stat.h>
+
+// Source of level generation numbers, shared by all levels so no two loads get the same number
+static unsigned int nextGeneration = 0;
+
+// Marks grid cells without a brick
+const unsigned int NO_BRICK = 0xFFFFFFFF;
+
+// Returns whether a file exists and was written after another one
+static bool isNewer(const std::string& file, const std::string& than)
+{
+    struct stat fileStatus, thanStatus;
+    return stat(file.c_str(), &fileStatus) == 0 && stat(than.c_str(), &thanStatus) == 0 && fileStatus.st_mtime > thanStatus.st_mtime;
+}
+
 
 // Loads the level from the specified file, parsing tile data and initializing the game level.
 void GameLevel::Load(std::string file, unsigned int levelWidth, unsigned int levelHeight)
 {
-    // Clear existing brick data.
-    this->Bricks.clear();
+    this->Load(Parse(file), levelWidth, levelHeight);
+}
+
+// Reads the tile codes of a level file, one row per line.
+// Compiled levels are preferred; they and packed levels are read straight from the mapped bytes.
+TileData GameLevel::Parse(const std::string& file)
+{
+    TileData tileData;
+    std::string compiled = file.substr(0, file.find_last_of('.')) + LEVEL_FILE_EXTENSION;
+    AssetView view;
+    if (ResourceManager::FindAsset(compiled, view))
+    {
+        if (readCompiled(view.Data, view.Size, tileData))
+            return tileData;
+    }
+    else if (isNewer(file, compiled))
+    {
+        // The text level was edited after it was compiled; the compiled file would hide the edit.
+        std::cout << "| LOAD: " << compiled << " is older than " << file << "; reading the text level" << std::endl;
+    }
+    else
+    {
+        MappedFile mapping;
+        if (mapping.Open(compiled) && readCompiled(mapping.Data(), mapping.Size(), tileData))
+            return tileData;
+    }
+
+    if (ResourceManager::FindAsset(file, view))
+    {
+        return parseTiles(reinterpret_cast<const char*>(view.Data), view.Size);
+    }
 
     // Read the level data from the file.
-    unsigned int tileCode;
-    GameLevel level;
-    std::string line;
-    std::ifstream fstream(file);
-    std::vector<std::vector<unsigned int>> tileData;
+    std::ifstream fstream(file, std::ios::binary);
+    if (!fstream)
+    {
+        return TileData();
+    }
+    std::stringstream contents;
+    contents << fstream.rdbuf();
+    std::string text = contents.str();
+    return parseTiles(text.data(), text.size());
+}
 
-    if (fstream)
+// Parses whitespace separated tile codes; every line of text becomes one row.
+TileData GameLevel::parseTiles(const char* text, size_t size)
+{
+    TileData tileData;
+    unsigned int rowLength = 0;
+    bool rowStarted = false;
+    bool ragged = false;
+    // Ends the current row; every row must have as many codes as the first one.
+    auto endRow = [&]() {
+        if (tileData.Rows == 0)
+            tileData.Columns = rowLength;
+        else if (rowLength != tileData.Columns)
+            ragged = true;
+        ++tileData.Rows;
+        rowLength = 0;
+        rowStarted = false;
+    };
+    for (size_t i = 0; i < size; ++i)
     {
-        // Read each line from the file and parse tile data.
-        while (std::getline(fstream, line)) 
+        char c = text[i];
+        if (c >= '0' && c <= '9')
         {
-            std::istringstream sstream(line);
-            std::vector<unsigned int> row;
-            while (sstream >> tileCode)
-            {   // Read each word separated by spaces.
-                row.push_back(tileCode);
+            // Read each word separated by spaces.
+            unsigned int tileCode = 0;
+            while (i < size && text[i] >= '0' && text[i] <= '9')
+            {
+                tileCode = tileCode * 10 + static_cast<unsigned int>(text[i] - '0');
+                ++i;
             }
-            tileData.push_back(row);
+            --i;
+            tileData.Tiles.push_back(static_cast<unsigned char>(tileCode > 255 ? 255 : tileCode));
+            ++rowLength;
+            rowStarted = true;
         }
-
-        // Initialize the level with the parsed tile data.
-        if (tileData.size() > 0)
+        else if (c == '\n')
         {
-            this->init(tileData, levelWidth, levelHeight);
+            // Blank lines are skipped rather than read as empty rows.
+            if (rowStarted)
+            {
+                endRow();
+            }
+        }
+        else if (c != '\r' && c != ' ' && c != '\t')
+        {
+            // Any other character makes the row invalid; whitespace alone does not start a row.
+            rowStarted = true;
         }
     }
+    // The last line may not end with a newline.
+    if (rowStarted)
+    {
+        endRow();
+    }
+    if (ragged || tileData.Columns == 0)
+    {
+        if (ragged)
+            std::cout << "ERROR::LEVEL: rows of different lengths" << std::endl;
+        return TileData();
+    }
+    return tileData;
+}
+
+// Compiled levels are copied with a single memcpy once the header and checksum match.
+bool GameLevel::readCompiled(const unsigned char* data, size_t size, TileData& tileData)
+{
+    LevelFileHeader header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    size_t count = static_cast<size_t>(header.Columns) * header.Rows;
+    if (std::memcmp(header.Magic, LEVEL_FILE_MAGIC, sizeof(header.Magic)) != 0 || header.Version != LEVEL_FILE_VERSION
+        || header.Columns == 0 || header.Rows == 0 || header.Columns > LEVEL_MAX_DIMENSION || header.Rows > LEVEL_MAX_DIMENSION
+        || size - sizeof(header) < count || LevelChecksum(data + sizeof(header), count) != header.Checksum)
+    {
+        std::cout << "ERROR::LEVEL: invalid compiled level" << std::endl;
+        return false;
+    }
+    tileData.Columns = header.Columns;
+    tileData.Rows = header.Rows;
+    tileData.Tiles.assign(data + sizeof(header), data + sizeof(header) + count);
+    return true;
+}
+
+// Replaces the level's bricks with the ones described by the tile data.
+void GameLevel::Load(const TileData& tileData, unsigned int levelWidth, unsigned int levelHeight)
+{
+    // Clear existing brick data; the brick buffer is rebuilt on the next draw.
+    this->BrickPositions.clear();
+    this->BrickCodes.clear();
+    this->BrickSize = glm::vec2(0.0f);
+    this->buffer.reset();
+    this->tileMap.reset();
+    this->breakableCount = 0;
+    this->destroyedCount = 0;
+    this->destroyed.clear();
+    this->tiles.clear();
+    this->pristineTiles.clear();
+    this->pristineInstances.clear();
+    this->brickCells.clear();
+    this->cellBricks.clear();
+    this->columns = this->rows = 0;
+    this->Generation = ++nextGeneration;
+
+    // Initialize the level with the parsed tile data.
+    if (tileData.Rows > 0)
+    {
+        this->init(tileData, levelWidth, levelHeight);
+    }
+}
+
+// Deletes the GL objects of the brick buffer.
+BrickBuffer::~BrickBuffer()
+{
+    RenderState::DeleteVertexArray(this->BreakableVAO);
+    RenderState::DeleteVertexArray(this->SolidVAO);
+    RenderState::DeleteBuffer(this->VBO);
 }
 
-// Draws all the non-destroyed bricks in the level.
-void GameLevel::Draw(SpriteRenderer& renderer)
+// Draws the level with one instanced call per brick type. Destroyed bricks stay in the
+// buffer with zero size, so the cost does not depend on how many bricks are left.
+void GameLevel::Draw(SpriteRenderer& renderer, BrickSet bricks)
 {
-    for (GameObject& tile : this->Bricks)
+    if (this->BrickPositions.empty())
+    {
+        return;
+    }
+    if (!this->buffer)
+    {
+        this->buildBuffer(renderer);
+    }
+
+    if (bricks != BRICKS_SOLID && this->breakableCount > 0)
+    {
+        renderer.DrawInstances(this->buffer->BreakableVAO, *this->blockSprite, this->breakableCount);
+    }
+    if (bricks != BRICKS_BREAKABLE && this->breakableCount < this->BrickCount())
+    {
+        renderer.DrawInstances(this->buffer->SolidVAO, *this->solidSprite, this->BrickCount() - this->breakableCount);
+    }
+}
+
+// Draws the level as one quad that looks up every tile in the tile map.
+void GameLevel::Draw(TileMapRenderer& renderer, BrickSet bricks)
+{
+    if (this->tiles.empty())
+    {
+        return;
+    }
+    if (!this->tileMap)
     {
-        if (!tile.Destroyed)
+        this->tileMap.reset(new TileMap());
+        this->tileMap->Generate(this->columns, this->rows, this->tiles.data());
+    }
+
+    // Code 1 marks solid bricks; every higher code is breakable.
+    unsigned int firstCode = bricks == BRICKS_BREAKABLE ? 2 : 1;
+    unsigned int lastCode = bricks == BRICKS_SOLID ? 1 : 255;
+    renderer.Draw(*this->tileMap, glm::vec2(0.0f), this->area, firstCode, lastCode);
+}
+
+// Builds the brick's GameObject from the brick arrays.
+GameObject GameLevel::Brick(size_t index) const
+{
+    GameObject brick(this->BrickPositions[index], this->BrickSize, this->IsSolid(index) ? *this->solidSprite : *this->blockSprite, TileColor(this->BrickCodes[index]));
+    brick.IsSolid = this->IsSolid(index);
+    brick.Destroyed = this->IsDestroyed(index);
+    return brick;
+}
+
+// Marks the brick as destroyed and collapses its slot in the brick buffer to zero size.
+void GameLevel::DestroyBrick(size_t index)
+{
+    if (this->IsDestroyed(index))
+    {
+        return;
+    }
+    this->destroyed[index / 64] |= uint64_t(1) << (index % 64);
+    if (!this->IsSolid(index))
+    {
+        ++this->destroyedCount;
+    }
+
+    // Clear the brick's tile; if the tile map exists only its texel is updated.
+    unsigned int cell = this->brickCells[index];
+    this->tiles[cell] = 0;
+    if (this->tileMap)
+    {
+        this->tileMap->SetTile(cell % this->columns, cell / this->columns, 0);
+    }
+
+    // Before the first draw there is nothing to update; the buffer is built from the current state.
+    if (this->buffer)
+    {
+        // A zero-sized quad produces no fragments, so this also works with blending disabled.
+        glm::vec2 size(0.0f);
+        GLintptr offset = index * sizeof(SpriteInstance) + offsetof(SpriteInstance, Size);
+        RenderState::BindBuffer(GL_ARRAY_BUFFER, this->buffer->VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, sizeof(glm::vec2), &size);
+    }
+}
+
+// Maps the rectangle onto the range of cells it touches; bricks fill their cells exactly, so
+// no brick outside the range can overlap it.
+void GameLevel::QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<size_t>& bricks) const
+{
+    bricks.clear();
+    if (this->cellBricks.empty() || max.x < 0.0f || max.y < 0.0f || min.x > this->area.x || min.y > this->area.y)
+    {
+        return;
+    }
+    unsigned int firstColumn = static_cast<unsigned int>(std::max(min.x / this->cellSize.x, 0.0f));
+    unsigned int firstRow = static_cast<unsigned int>(std::max(min.y / this->cellSize.y, 0.0f));
+    unsigned int lastColumn = std::min(static_cast<unsigned int>(max.x / this->cellSize.x), this->columns - 1);
+    unsigned int lastRow = std::min(static_cast<unsigned int>(max.y / this->cellSize.y), this->rows - 1);
+    for (unsigned int y = firstRow; y <= lastRow; ++y)
+    {
+        for (unsigned int x = firstColumn; x <= lastColumn; ++x)
         {
-            tile.Draw(renderer);
+            unsigned int brick = this->cellBricks[y * this->columns + x];
+            if (brick != NO_BRICK)
+            {
+                bricks.push_back(brick);
+            }
         }
     }
+    // Visit the bricks in the order a full scan of the brick arrays would.
+    std::sort(bricks.begin(), bricks.end());
+}
+
+// Restores the bricks from the copies kept at load time: the destroyed flags are cleared,
+// the tile grid is copied back and the GPU copies are overwritten in place.
+void GameLevel::Reset()
+{
+    std::fill(this->destroyed.begin(), this->destroyed.end(), 0);
+    this->destroyedCount = 0;
+    std::copy(this->pristineTiles.begin(), this->pristineTiles.end(), this->tiles.begin());
+
+    if (this->tileMap)
+    {
+        this->tileMap->SetTiles(this->tiles.data());
+    }
+    if (this->buffer)
+    {
+        RenderState::BindBuffer(GL_ARRAY_BUFFER, this->buffer->VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, this->pristineInstances.size() * sizeof(SpriteInstance), this->pristineInstances.data());
+    }
 }
 
 // Checks if the level is completed (all non-solid tiles are destroyed).
-bool GameLevel::IsCompleted()
+bool GameLevel::IsCompleted() const
 {
-    for (GameObject& tile : this->Bricks)
+    return this->breakableCount > 0 && this->destroyedCount == this->breakableCount;
+}
+
+// Returns the color of the given tile code.
+glm::vec3 GameLevel::TileColor(unsigned int code)
+{
+    switch (code)
+    {
+    // Solid
+    case 1:
+        return glm::vec3(0.8f, 0.8f, 0.7f);
+    // Blue
+    case 2:
+        return glm::vec3(0.2f, 0.6f, 1.0f);
+    // Green
+    case 3:
+        return glm::vec3(0.0f, 0.7f, 0.0f);
+    // Brown
+    case 4:
+        return glm::vec3(0.8f, 0.8f, 0.4f);
+    // Orange
+    case 5:
+        return glm::vec3(1.0f, 0.5f, 0.0f);
+    default:
+        return glm::vec3(1.0f);
+    }
+}
+
+// Uploads every brick as a sprite instance and sets up a vertex array for each brick type.
+void GameLevel::buildBuffer(SpriteRenderer& renderer)
+{
+    this->pristineInstances.resize(this->BrickCount());
+    bool anyDestroyed = false;
+    for (size_t i = 0; i < this->BrickCount(); ++i)
+    {
+        SpriteInstance& instance = this->pristineInstances[i];
+        instance.Position = this->BrickPositions[i];
+        instance.Size = this->BrickSize;
+        instance.Color = glm::vec4(TileColor(this->BrickCodes[i]), 1.0f);
+        instance.Rotation = 0.0f;
+        instance.Region = this->IsSolid(i) ? this->solidSprite->Region : this->blockSprite->Region;
+        instance.TextureIndex = this->IsSolid(i) ? 1 : 0;
+        anyDestroyed = anyDestroyed || this->IsDestroyed(i);
+    }
+
+    // Bricks destroyed before the first draw are uploaded with zero size.
+    std::vector<SpriteInstance> instances;
+    if (anyDestroyed)
     {
-        if (!tile.IsSolid && !tile.Destroyed)
+        instances = this->pristineInstances;
+        for (size_t i = 0; i < this->BrickCount(); ++i)
         {
-            return false;
+            if (this->IsDestroyed(i))
+            {
+                instances[i].Size = glm::vec2(0.0f);
+            }
         }
     }
-    return true;
+    const std::vector<SpriteInstance>& upload = anyDestroyed ? instances : this->pristineInstances;
+
+    this->buffer.reset(new BrickBuffer());
+    glGenBuffers(1, &this->buffer->VBO);
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, this->buffer->VBO);
+    glBufferData(GL_ARRAY_BUFFER, upload.size() * sizeof(SpriteInstance), upload.data(), GL_STATIC_DRAW);
+
+    this->buffer->BreakableVAO = renderer.CreateInstanceArray(this->buffer->VBO, 0);
+    this->buffer->SolidVAO = renderer.CreateInstanceArray(this->buffer->VBO, this->breakableCount);
 }
 
 // Initializes the level using tile data and the specified level dimensions.
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::init(const TileData& tileData, unsigned int levelWidth, unsigned int levelHeight)
 {
     // Calculate tile dimensions based on the level size.
-    float height = static_cast<float>(tileData.size());
-    float width = static_cast<float>(tileData[0].size()); // note we can index vector at [0] since this function is only called if height > 0
-    float unit_width = static_cast<float>(levelWidth) / static_cast<float>(width);
-    float unit_height = static_cast<float>(levelHeight) / static_cast<float>(height);
+    float unit_width = static_cast<float>(levelWidth) / static_cast<float>(tileData.Columns);
+    float unit_height = static_cast<float>(levelHeight) / static_cast<float>(tileData.Rows);
+
+    // Every brick fills one cell and uses one of the two block textures.
+    this->BrickSize = glm::vec2(unit_width, unit_height);
+    this->blockSprite = &ResourceManager::GetTexture("block");
+    this->solidSprite = &ResourceManager::GetTexture("block_solid");
 
-    // Initialize the level's bricks based on the tile data	.
-    for (unsigned int y = 0; y < height; ++y)
+    // Keep the grid itself for the tile map renderer.
+    this->columns = tileData.Columns;
+    this->rows = tileData.Rows;
+    this->area = glm::vec2(levelWidth, levelHeight);
+    this->tiles = tileData.Tiles;
+    this->pristineTiles = tileData.Tiles;
+
+    // Initialize the level's bricks based on the tile data: the breakable bricks (codes above 1,
+    // which also pick the color) in a first pass, then the solid bricks (code 1) after them.
+    for (int pass = 0; pass < 2; ++pass)
     {
-        for (unsigned int x = 0; x < width; ++x)
+        for (unsigned int cell = 0; cell < this->tiles.size(); ++cell)
         {
-            // Set width, height and default color (white).
-            glm::vec2 pos(unit_width * x, unit_height * y);
-            glm::vec2 size(unit_width, unit_height);
-            glm::vec3 color = glm::vec3(1.0f); // Default color (white).
-
-            if (tileData[y][x] == 1) // Solid block.
+            unsigned char code = this->tiles[cell];
+            if (code == 0 || (code == 1) != (pass == 1))
             {
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
-                obj.IsSolid = true;
-                this->Bricks.push_back(obj);
-            }
-            else if (tileData[y][x] > 1) // Non-solid block; determine color based on tile type.
-            {
-                switch (tileData[y][x])
-                {
-                // Blue
-                case 2:
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                    break;
-                // Green
-                case 3:
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                    break;
-                // Brown
-                case 4:
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                    break;
-                // Orange
-                case 5:
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-                    break;
-                default:
-                    break;
-                }
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
+                continue;
             }
+            this->BrickPositions.push_back(glm::vec2(unit_width * (cell % this->columns), unit_height * (cell / this->columns)));
+            this->BrickCodes.push_back(code);
+            this->brickCells.push_back(cell);
+        }
+        if (pass == 0)
+        {
+            this->breakableCount = this->BrickPositions.size();
         }
     }
+    this->destroyed.assign((this->BrickCount() + 63) / 64, 0);
+
+    // Index the bricks by cell for QueryBricks.
+    this->cellSize = glm::vec2(unit_width, unit_height);
+    this->cellBricks.assign(this->tiles.size(), NO_BRICK);
+    for (size_t i = 0; i < this->brickCells.size(); ++i)
+    {
+        this->cellBricks[this->brickCells[i]] = static_cast<unsigned int>(i);
+    }
 }
 
@@ -41,15 +41,24 @@ HighScoreDB::~HighScoreDB() {
 
 // Function to create a high score table for a specific level if it doesn't already exist
 bool HighScoreDB::createTable(int level) {
+    // Each table is only created once per run.
+    if (createdTables.count(level)) {
+        return true;
+    }
     std::string query = "CREATE TABLE IF NOT EXISTS level_" + std::to_string(level) + "_highscores ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "player_name TEXT, "
         "completion_time REAL);";
-    return executeQuery(query);
+    if (!executeQuery(query)) {
+        return false;
+    }
+    createdTables.insert(level);
+    return true;
 }
 
 // Function to add a new high score entry for a specific level
 bool HighScoreDB::addScore(int level, const std::string& playerName, double completionTime) {
+    createTable(level);
     std::string query = "INSERT INTO level_" + std::to_string(level) + "_highscores (player_name, completion_time) VALUES (?, ?);";
     sqlite3_stmt* stmt;
 
@@ -84,6 +93,7 @@ bool HighScoreDB::addScore(int level, const std::string& playerName, double comp
 // Function to retrieve the top 10 high scores for a given level
 std::vector<HighScore> HighScoreDB::getHighScores(int level) {
     std::vector<HighScore> scores;
+    createTable(level);
     std::string query = "SELECT player_name, completion_time FROM level_" + std::to_string(level) + "_highscores "
         "ORDER BY completion_time ASC LIMIT 10;";
     sqlite3_stmt* stmt;
@@ -125,6 +135,7 @@ float HighScoreDB::getSlowestHighScore(int level) {
     }
 
     float slowestHighScore = -1.0f; // Default value when no scores exist
+    createTable(level);
 
     // Query to get the 10th slowest high score for the level
     std::string query = "SELECT completion_time FROM level_" + std::to_string(level) + "_highscores "
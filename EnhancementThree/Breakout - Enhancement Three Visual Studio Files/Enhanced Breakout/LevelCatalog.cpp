@@ -0,0 +1,204 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "level_catalog.h"
+#include "level_file.h"
+#include "resource_manager.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+// Reads the level number from a file name such as "12.lvl" or "12.blvl".
+// Returns 0 for anything else, e.g. "TEST.lvl".
+static unsigned int levelNumber(const std::string& name)
+{
+    size_t dot = name.find('.');
+    if (dot == 0 || dot == std::string::npos)
+        return 0;
+    std::string extension = name.substr(dot);
+    for (char& c : extension)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (extension != ".lvl" && extension != LEVEL_FILE_EXTENSION)
+        return 0;
+    unsigned int number = 0;
+    for (size_t i = 0; i < dot; ++i)
+    {
+        if (!std::isdigit(static_cast<unsigned char>(name[i])) || number > 100000)
+            return 0;
+        number = number * 10 + static_cast<unsigned int>(name[i] - '0');
+    }
+    return number;
+}
+
+// Returns the names of the files in a directory
+static std::vector<std::string> listDirectory(const std::string& directory)
+{
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA((directory + "\\*").c_str(), &found);
+    if (search == INVALID_HANDLE_VALUE)
+        return names;
+    do
+    {
+        if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            names.push_back(found.cFileName);
+    } while (FindNextFileA(search, &found));
+    FindClose(search);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return names;
+    while (dirent* entry = readdir(dir))
+        names.push_back(entry->d_name);
+    closedir(dir);
+#endif
+    return names;
+}
+
+
+void LevelCatalog::Scan(const std::string& directory, unsigned int levelWidth, unsigned int levelHeight)
+{
+    this->entries.clear();
+    this->selected = 0;
+    this->directory = directory;
+    this->levelWidth = levelWidth;
+    this->levelHeight = levelHeight;
+
+    // Pack names carry the directory; only the file name part matters here.
+    std::vector<std::string> names = ResourceManager::ListAssets(directory);
+    for (std::string& name : names)
+        name = name.substr(name.find_last_of('/') + 1);
+    if (names.empty())
+        names = listDirectory(directory);
+
+    // A level may exist as text, compiled or both; it is listed once under its text name,
+    // and GameLevel::Parse picks the compiled file when there is one that is up to date.
+    std::vector<unsigned int> numbers;
+    for (const std::string& name : names)
+    {
+        unsigned int number = levelNumber(name);
+        if (number != 0)
+            numbers.push_back(number);
+    }
+    std::sort(numbers.begin(), numbers.end());
+    numbers.erase(std::unique(numbers.begin(), numbers.end()), numbers.end());
+
+    this->entries.resize(numbers.size());
+    for (size_t i = 0; i < numbers.size(); ++i)
+    {
+        this->entries[i].Number = numbers[i];
+        this->entries[i].File = directory + "/" + std::to_string(numbers[i]) + ".lvl";
+    }
+    if (this->entries.empty())
+        std::cout << "ERROR::LEVEL: no levels found in " << directory << std::endl;
+}
+
+GameLevel& LevelCatalog::operator[](size_t index)
+{
+    if (index >= this->entries.size())
+        return this->empty;
+
+    Entry& entry = this->entries[index];
+    if (!entry.Level)
+    {
+        // Use the prefetched tiles if the background parse was started, otherwise parse now.
+        TileData tiles = entry.Parsed.valid() ? entry.Parsed.get() : GameLevel::Parse(entry.File);
+        entry.Level.reset(new GameLevel());
+        entry.Level->Load(tiles, this->levelWidth, this->levelHeight);
+    }
+    return *entry.Level;
+}
+
+void LevelCatalog::Select(size_t index)
+{
+    size_t count = this->entries.size();
+    if (index >= count)
+        return;
+    this->selected = index;
+    size_t next = (index + 1) % count;
+    size_t previous = (index + count - 1) % count;
+
+    // Release everything but the selection and its neighbours. Dropping a parse that is
+    // still running waits for it, which costs no more than the parse itself.
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i != index && i != next && i != previous)
+        {
+            this->entries[i].Level.reset();
+            this->entries[i].Parsed = std::future<TileData>();
+        }
+    }
+
+    (*this)[index];
+    this->prefetch(next);
+    this->prefetch(previous);
+}
+
+bool LevelCatalog::FileChanged(const std::string& file)
+{
+    size_t separator = file.find_last_of("/\\");
+    std::string directory = separator == std::string::npos ? "" : file.substr(0, separator);
+    unsigned int number = levelNumber(file.substr(separator + 1));
+    if (number == 0 || ResourceManager::PackName(directory) != ResourceManager::PackName(this->directory))
+        return false;
+
+    auto found = std::lower_bound(this->entries.begin(), this->entries.end(), number,
+        [](const Entry& entry, unsigned int number) { return entry.Number < number; });
+    if (found == this->entries.end() || found->Number != number)
+    {
+        // A new level: list it in numeric order. It is loaded when it is selected. Every later
+        // index shifts by one, so the selection follows its level and the neighbours are refreshed.
+        size_t index = static_cast<size_t>(found - this->entries.begin());
+        Entry entry;
+        entry.Number = number;
+        entry.File = this->directory + "/" + std::to_string(number) + ".lvl";
+        this->entries.insert(found, std::move(entry));
+        if (this->entries.size() > 1 && index <= this->selected)
+            ++this->selected;
+        this->Select(this->selected);
+        std::cout << "| RELOAD: level " << number << " added" << std::endl;
+        return true;
+    }
+
+    // Parse afresh; a prefetch still running may have read the old file.
+    size_t index = static_cast<size_t>(found - this->entries.begin());
+    bool prefetched = found->Parsed.valid();
+    found->Parsed = std::future<TileData>();
+    if (found->Level)
+    {
+        found->Level->Load(GameLevel::Parse(found->File), this->levelWidth, this->levelHeight);
+        std::cout << "| RELOAD: level " << number << " reloaded" << std::endl;
+    }
+    else if (prefetched)
+        this->prefetch(index);
+    return true;
+}
+
+void LevelCatalog::prefetch(size_t index)
+{
+    Entry& entry = this->entries[index];
+    if (entry.Level || entry.Parsed.valid())
+        return;
+    entry.Parsed = std::async(std::launch::async, GameLevel::Parse, entry.File);
+}
@@ -12,6 +12,9 @@
 ******************************************************************/
 
 #include "particle_generator.h"
+#include "render_state.h"
+
+#include <cstddef>
 
 // ---Constants---
 const float RANDOM_POSITION_SCALE = 10.0f; // Scale for randomizing particle position
@@ -22,9 +25,17 @@ const float RANDOM_COLOR_OFFSET = 0.5f;    // Base value for randomizing particl
 ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
 	: shader(shader), texture(texture), amount(amount)
 {
+	this->configureShader();
 	this->init();
 }
 
+// Points the shader at the particle image, which may be a region of a sprite atlas.
+void ParticleGenerator::configureShader()
+{
+	this->shader.SetVector4f("region", this->texture.Region, true);
+	this->shaderRevision = this->shader.Revision();
+}
+
 // Updates the state of all particles and spawns new ones.
 // Parameters:
 // - dt: Delta time (time elapsed since the last frame).
@@ -61,29 +72,43 @@ void ParticleGenerator::Update(float dt, GameObject& object, unsigned int newPar
 // Renders all active particles
 void ParticleGenerator::Draw()
 {
-	// Use additive blending to give a "glow" effect.
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-	this->shader.Use();
+	// Skip the particles until their program has linked.
+	if (!this->shader.IsReady())
+	{
+		return;
+	}
+	if (this->shader.Revision() != this->shaderRevision)
+	{
+		this->configureShader();
+	}
 
-	// Set shader offset, shader color, bind the texture for each particle, then render each particle.
+	// Gather the offset and color of every live particle.
+	this->instances.clear();
 	for (const Particle& particle : this->particles)
 	{
 		if (particle.Life > 0.0f)
 		{
-			// Set particle properties in the shader.
-			this->shader.SetVector2f("offset", particle.Position);
-			this->shader.SetVector4f("color", particle.Color);
-
-			// Bind the particle texture and draw.
-			this->texture.Bind();
-			glBindVertexArray(this->VAO);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			glBindVertexArray(0);
+			this->instances.push_back({ particle.Position, particle.Color });
 		}
 	}
+	if (this->instances.empty())
+	{
+		return;
+	}
+
+	// Stream the instance data; orphaning the buffer first avoids stalling on last frame's draw.
+	RenderState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(ParticleInstance), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, this->instances.size() * sizeof(ParticleInstance), this->instances.data());
 
-	// Reset to default blending mode.
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// The caller selects additive blending for the "glow" effect (see RENDER_PASS_ADDITIVE).
+	this->shader.Use();
+
+	// Bind the particle texture and draw every live particle at once.
+	RenderState::ActiveTexture(GL_TEXTURE0);
+	this->texture.Bind();
+	RenderState::BindVertexArray(this->VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(this->instances.size()));
 }
 
 // Initializes the particle system's OpenGL buffers and creates the particle array (used in the constructor).
@@ -104,22 +129,34 @@ void ParticleGenerator::init()
 	// Generate OpenGL buffers and configure attributes.
 	glGenVertexArrays(1, &this->VAO);
 	glGenBuffers(1, &VBO);
-	glBindVertexArray(this->VAO);
+	RenderState::BindVertexArray(this->VAO);
 
 	// Fill mesh buffer.
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	RenderState::BindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
 
 	// Set mesh attributes.
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-	glBindVertexArray(0);
+
+	// Allocate the instance buffer for the maximum number of live particles and set the
+	// per-instance attributes (offset and color), which advance once per particle.
+	glGenBuffers(1, &this->instanceVBO);
+	RenderState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(ParticleInstance), NULL, GL_STREAM_DRAW);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Offset));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Color));
+	glVertexAttribDivisor(2, 1);
 
 	// Create pre-defined amount (this->amount) of particle instances.
 	for (unsigned int i = 0; i < this->amount; ++i)
 	{
 		this->particles.push_back(Particle());
 	}
+	this->instances.reserve(this->amount);
 }
 
 // Variable for keeping track of the last dead particle respawned.
@@ -0,0 +1,206 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "program_cache.h"
+
+#include <GLFW/glfw3.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Enumerants of ARB_get_program_binary (core since GL 4.1), which glad's 3.3 profile does not define
+const GLenum PROGRAM_BINARY_RETRIEVABLE_HINT = 0x8257;
+const GLenum PROGRAM_BINARY_LENGTH = 0x8741;
+const GLenum NUM_PROGRAM_BINARY_FORMATS = 0x87FE;
+
+// Entry points of ARB_get_program_binary
+typedef void (APIENTRYP GetProgramBinaryFunction)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryFunction)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriFunction)(GLuint program, GLenum pname, GLint value);
+
+static GetProgramBinaryFunction  getProgramBinary = nullptr;
+static ProgramBinaryFunction     programBinary = nullptr;
+static ProgramParameteriFunction programParameteri = nullptr;
+
+// Cache state
+static std::string  cacheDirectory;
+static bool         enabled = false;
+static unsigned int hits = 0, misses = 0;
+
+// Header of a cache file, followed by the binary itself
+struct CacheFileHeader {
+    char     Magic[4];
+    uint32_t Format;   // Driver specific binary format
+    uint64_t Key;      // Guards against renamed or truncated files
+    uint32_t Length;   // Size of the binary in bytes
+    uint32_t Reserved;
+};
+const char CACHE_MAGIC[4] = { 'B', 'K', 'P', 'B' };
+
+// 64-bit FNV-1a over a NUL-terminated string, including the terminator so that
+// consecutive strings cannot run into each other.
+static uint64_t hashString(uint64_t hash, const char* text)
+{
+    const uint64_t prime = 0x100000001b3ULL;
+    for (const char* c = text ? text : ""; ; ++c)
+    {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * prime;
+        if (*c == '\0')
+            break;
+    }
+    return hash;
+}
+
+
+void ProgramCache::Init(const std::string& directory)
+{
+    cacheDirectory = directory;
+    getProgramBinary = reinterpret_cast<GetProgramBinaryFunction>(glfwGetProcAddress("glGetProgramBinary"));
+    programBinary = reinterpret_cast<ProgramBinaryFunction>(glfwGetProcAddress("glProgramBinary"));
+    programParameteri = reinterpret_cast<ProgramParameteriFunction>(glfwGetProcAddress("glProgramParameteri"));
+
+    // Some drivers export the entry points but support no binary formats.
+    GLint formats = 0;
+    if (getProgramBinary && programBinary)
+        glGetIntegerv(NUM_PROGRAM_BINARY_FORMATS, &formats);
+    enabled = formats > 0;
+    if (!enabled)
+    {
+        std::cout << "| SHADER: program binaries are not supported, the program cache is disabled" << std::endl;
+        return;
+    }
+
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+
+bool ProgramCache::IsEnabled()
+{
+    return enabled;
+}
+
+uint64_t ProgramCache::Key(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = hashString(hash, vertexSource);
+    hash = hashString(hash, fragmentSource);
+    hash = hashString(hash, geometrySource);
+
+    // Binaries are only valid for the driver that produced them.
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    return hash;
+}
+
+void ProgramCache::MarkRetrievable(unsigned int program)
+{
+    if (enabled && programParameteri)
+        programParameteri(program, PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool ProgramCache::Load(unsigned int program, uint64_t key)
+{
+    if (!enabled)
+        return false;
+
+    std::ifstream file(path(key), std::ios::binary);
+    CacheFileHeader header;
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.Key != key)
+    {
+        ++misses;
+        return false;
+    }
+    // The length comes from the file; check it against the bytes that follow before allocating.
+    std::streampos start = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - start;
+    file.seekg(start);
+    if (header.Length == 0 || remaining != static_cast<std::streamoff>(header.Length))
+    {
+        ++misses;
+        return false;
+    }
+    std::vector<char> binary(header.Length);
+    if (!file.read(binary.data(), binary.size()))
+    {
+        ++misses;
+        return false;
+    }
+
+    // A driver update can invalidate a binary even when the version string is unchanged;
+    // the link status tells whether the driver accepted it.
+    programBinary(program, header.Format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    return true;
+}
+
+void ProgramCache::Store(unsigned int program, uint64_t key)
+{
+    if (!enabled)
+        return;
+
+    GLint linked = GL_FALSE, length = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, PROGRAM_BINARY_LENGTH, &length);
+    if (!linked || length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    getProgramBinary(program, length, &length, &format, binary.data());
+
+    CacheFileHeader header;
+    std::memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.Format = format;
+    header.Key = key;
+    header.Length = static_cast<uint32_t>(length);
+    header.Reserved = 0;
+
+    std::ofstream file(path(key), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+    if (!file)
+        std::cout << "| SHADER: failed to write program cache file " << path(key) << std::endl;
+}
+
+void ProgramCache::Report()
+{
+    if (enabled)
+        std::cout << "| SHADER: program cache: " << hits << " hits, " << misses << " misses" << std::endl;
+}
+
+std::string ProgramCache::path(uint64_t key)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; --i, key >>= 4)
+        name[i] = digits[key & 0xF];
+    return cacheDirectory + "/" + name + ".bin";
+}
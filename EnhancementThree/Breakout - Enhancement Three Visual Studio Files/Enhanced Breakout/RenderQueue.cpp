@@ -0,0 +1,72 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "render_queue.h"
+#include "render_state.h"
+
+#include <algorithm>
+
+// Sort key layout (most significant bits first):
+//   opaque:  [63:62] 0 | [47:32] program | [31:16] texture | [15:0] depth
+//   blended: [63:62] 1 | [61:46] depth   | [45:44] blend mode | [43:28] program | [27:12] texture
+// Programs and textures are truncated to 16 bits, which only affects grouping.
+const uint64_t FIELD_MASK = 0xFFFF;
+
+
+void RenderQueue::Submit(RenderPass pass, unsigned int depth, unsigned int program, unsigned int texture, std::function<void()> draw)
+{
+    RenderCommand command;
+    command.Key = MakeKey(pass, depth, program, texture);
+    command.Pass = pass;
+    command.Draw = std::move(draw);
+    this->commands.push_back(std::move(command));
+}
+
+void RenderQueue::Execute()
+{
+    std::stable_sort(this->commands.begin(), this->commands.end(),
+        [](const RenderCommand& a, const RenderCommand& b) { return a.Key < b.Key; });
+
+    for (RenderCommand& command : this->commands)
+    {
+        // RenderState skips the changes when consecutive commands share a pass.
+        switch (command.Pass)
+        {
+        case RENDER_PASS_OPAQUE:
+            RenderState::SetBlend(false);
+            break;
+        case RENDER_PASS_ALPHA:
+            RenderState::SetBlend(true);
+            RenderState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case RENDER_PASS_ADDITIVE:
+            RenderState::SetBlend(true);
+            RenderState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+            break;
+        }
+        command.Draw();
+    }
+    this->commands.clear();
+
+    // Leave the default state for code that draws outside the queue.
+    RenderState::SetBlend(true);
+    RenderState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, unsigned int depth, unsigned int program, unsigned int texture)
+{
+    if (pass == RENDER_PASS_OPAQUE)
+    {
+        return ((program & FIELD_MASK) << 32) | ((texture & FIELD_MASK) << 16) | (depth & FIELD_MASK);
+    }
+    uint64_t blendMode = pass == RENDER_PASS_ADDITIVE ? 1 : 0;
+    return (uint64_t(1) << 62) | ((depth & FIELD_MASK) << 46) | (blendMode << 44)
+        | ((program & FIELD_MASK) << 28) | ((texture & FIELD_MASK) << 12);
+}
@@ -0,0 +1,193 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "render_state.h"
+
+// Value used for state that is not known to the cache
+const unsigned int UNKNOWN_STATE = 0xFFFFFFFFu;
+
+// --- Cached state ---
+static unsigned int currentProgram = UNKNOWN_STATE;
+static unsigned int activeUnit = UNKNOWN_STATE;
+static unsigned int boundTextures[RENDER_STATE_TEXTURE_UNITS][2];
+static unsigned int boundVertexArray = UNKNOWN_STATE;
+static unsigned int boundArrayBuffer = UNKNOWN_STATE;
+static int          blendEnabled = -1;  // -1 unknown, 0 disabled, 1 enabled
+static unsigned int blendSource = UNKNOWN_STATE, blendDestination = UNKNOWN_STATE;
+static bool         textureCacheReady = false;
+static RenderStateStats stats;
+
+// Marks every texture binding as unknown.
+static void forgetTextures()
+{
+    for (unsigned int unit = 0; unit < RENDER_STATE_TEXTURE_UNITS; ++unit)
+    {
+        boundTextures[unit][0] = UNKNOWN_STATE;
+        boundTextures[unit][1] = UNKNOWN_STATE;
+    }
+    textureCacheReady = true;
+}
+
+// Records whether a state change was issued or elided and returns whether it must be issued.
+static bool track(unsigned int& cached, unsigned int requested)
+{
+    if (cached == requested)
+    {
+        ++stats.Elided;
+        return false;
+    }
+    cached = requested;
+    ++stats.Issued;
+    return true;
+}
+
+void RenderState::UseProgram(unsigned int program)
+{
+    if (track(currentProgram, program))
+        glUseProgram(program);
+}
+
+void RenderState::ActiveTexture(unsigned int unit)
+{
+    if (track(activeUnit, unit))
+        glActiveTexture(unit);
+}
+
+void RenderState::BindTexture(unsigned int target, unsigned int texture)
+{
+    if (!textureCacheReady)
+        forgetTextures();
+
+    // Bindings are tracked per unit, so the active unit has to be known as well.
+    unsigned int unit = activeUnit - GL_TEXTURE0;
+    int slot = targetSlot(target);
+    if (slot < 0 || activeUnit == UNKNOWN_STATE || unit >= RENDER_STATE_TEXTURE_UNITS)
+    {
+        ++stats.Issued;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (track(boundTextures[unit][slot], texture))
+        glBindTexture(target, texture);
+}
+
+void RenderState::BindVertexArray(unsigned int vao)
+{
+    if (track(boundVertexArray, vao))
+        glBindVertexArray(vao);
+}
+
+void RenderState::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    if (target != GL_ARRAY_BUFFER)
+    {
+        ++stats.Issued;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (track(boundArrayBuffer, buffer))
+        glBindBuffer(target, buffer);
+}
+
+void RenderState::SetBlend(bool enabled)
+{
+    if (blendEnabled == (enabled ? 1 : 0))
+    {
+        ++stats.Elided;
+        return;
+    }
+    blendEnabled = enabled ? 1 : 0;
+    ++stats.Issued;
+    if (enabled)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+}
+
+void RenderState::BlendFunc(unsigned int source, unsigned int destination)
+{
+    if (blendSource == source && blendDestination == destination)
+    {
+        ++stats.Elided;
+        return;
+    }
+    blendSource = source;
+    blendDestination = destination;
+    ++stats.Issued;
+    glBlendFunc(source, destination);
+}
+
+void RenderState::DeleteProgram(unsigned int program)
+{
+    // Deleting the current program only flags it for deletion, so the binding stays valid until it changes.
+    if (currentProgram == program)
+        currentProgram = UNKNOWN_STATE;
+    glDeleteProgram(program);
+}
+
+void RenderState::DeleteTexture(unsigned int texture)
+{
+    // OpenGL resets bindings of a deleted texture to 0 on every unit.
+    if (textureCacheReady)
+    {
+        for (unsigned int unit = 0; unit < RENDER_STATE_TEXTURE_UNITS; ++unit)
+        {
+            for (unsigned int slot = 0; slot < 2; ++slot)
+            {
+                if (boundTextures[unit][slot] == texture)
+                    boundTextures[unit][slot] = 0;
+            }
+        }
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void RenderState::DeleteVertexArray(unsigned int vao)
+{
+    if (boundVertexArray == vao)
+        boundVertexArray = 0;
+    glDeleteVertexArrays(1, &vao);
+}
+
+void RenderState::DeleteBuffer(unsigned int buffer)
+{
+    if (boundArrayBuffer == buffer)
+        boundArrayBuffer = 0;
+    glDeleteBuffers(1, &buffer);
+}
+
+void RenderState::Invalidate()
+{
+    currentProgram = UNKNOWN_STATE;
+    activeUnit = UNKNOWN_STATE;
+    boundVertexArray = UNKNOWN_STATE;
+    boundArrayBuffer = UNKNOWN_STATE;
+    blendEnabled = -1;
+    blendSource = UNKNOWN_STATE;
+    blendDestination = UNKNOWN_STATE;
+    forgetTextures();
+}
+
+const RenderStateStats& RenderState::Stats()
+{
+    return stats;
+}
+
+void RenderState::ResetStats()
+{
+    stats = RenderStateStats();
+}
+
+int RenderState::targetSlot(unsigned int target)
+{
+    if (target == GL_TEXTURE_2D)
+        return 0;
+    if (target == GL_TEXTURE_2D_ARRAY)
+        return 1;
+    return -1;
+}
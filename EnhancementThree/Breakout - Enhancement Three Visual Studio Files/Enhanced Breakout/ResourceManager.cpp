@@ -11,12 +11,70 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <thread>
 
 #include "stb_image.h"
+#include "program_cache.h"
+#include "render_state.h"
+#include "shelf_packer.h"
+#include "gpu_texture.h"
+
+// Atlas layout
+const int SPRITE_ATLAS_WIDTH = 1024;  // Width of sprite atlases in pixels
+const int SPRITE_PADDING = 2;         // Pixels around each image filled with its edge to prevent bleeding
 
 // Instantiate static variables for storing shaders and textures
 std::map<std::string, Texture2D>    ResourceManager::Textures;   // Map to store textures by name
 std::map<std::string, Shader>       ResourceManager::Shaders;    // Map to store shaders by name
+AssetPack                           ResourceManager::Pack;       // Optional asset pack
+
+// A shader submitted without waiting, remembered until FinishShaders() caches its binary
+struct PendingShader {
+    std::string Label;
+    uint64_t    CacheKey;
+    Shader      Program;    // Shares its compile state with the copy in the Shaders map
+    std::chrono::high_resolution_clock::time_point Start;
+};
+static std::vector<PendingShader> pendingShaders;
+
+// Files each shader and texture was loaded from, so a changed file can be reloaded (see Reload)
+struct ShaderFiles {
+    std::string Vertex, Fragment, Geometry;  // Geometry is empty when the shader has none
+};
+struct TextureFile {
+    std::string File;
+    std::string Atlas;   // Name of the atlas the image is packed into; empty for standalone textures
+    bool        Alpha;
+};
+static std::map<std::string, ShaderFiles> shaderFiles;
+static std::map<std::string, TextureFile> textureFiles;
+
+// Returns the pack name of a file without its extension, so "block.png" and "block.gtex" match
+static std::string assetBase(const std::string& file)
+{
+    std::string name = ResourceManager::PackName(file);
+    size_t extension = name.find_last_of('.');
+    if (extension != std::string::npos && name.find('/', extension) == std::string::npos)
+        name.erase(extension);
+    return name;
+}
+
+// Reads a whole text file; returns false if it cannot be opened
+static bool readTextFile(const std::string& file, std::string& text)
+{
+    std::ifstream input(file, std::ios::binary);
+    if (!input)
+        return false;
+    text.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    return true;
+}
 
 // Loads and generates a shader program from vertex, fragment, and optional geometry shader files.
 // Stores the generated shader in the Shaders map for future access.
@@ -24,9 +82,45 @@ Shader ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderF
 {
     // Load and compile the shader, then store it in the map with the given nam
     Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+    shaderFiles[name] = { vShaderFile, fShaderFile, gShaderFile != nullptr ? gShaderFile : "" };
     return Shaders[name];
 }
 
+// Starts compiling a shader program and stores it before it has linked.
+void ResourceManager::SubmitShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name)
+{
+    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile, false);
+    shaderFiles[name] = { vShaderFile, fShaderFile, gShaderFile != nullptr ? gShaderFile : "" };
+}
+
+// Polls the submitted programs so that each one is finished as soon as the driver completes it.
+void ResourceManager::FinishShaders()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    while (!pendingShaders.empty())
+    {
+        bool progress = false;
+        for (size_t i = 0; i < pendingShaders.size(); )
+        {
+            PendingShader& shader = pendingShaders[i];
+            if (!shader.Program.IsReady())
+            {
+                ++i;
+                continue;
+            }
+            ProgramCache::Store(shader.Program.ID, shader.CacheKey);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - shader.Start;
+            std::cout << "| SHADER: " << shader.Label << ": compiled in " << elapsed.count() << " ms" << std::endl;
+            pendingShaders.erase(pendingShaders.begin() + i);
+            progress = true;
+        }
+        if (!progress)
+            std::this_thread::yield();
+    }
+    std::chrono::duration<double, std::milli> waited = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "| SHADER: waited " << waited.count() << " ms for submitted programs" << std::endl;
+}
+
 // Retrieves a stored shader by its name.
 Shader& ResourceManager::GetShader(std::string name)
 {
@@ -37,31 +131,225 @@ Shader& ResourceManager::GetShader(std::string name)
 // Loads and generates a texture from a file. Stores the generated texture in the Textures map.
 Texture2D ResourceManager::LoadTexture(const char* file, bool alpha, std::string name)
 {
-    // Load the texture and store it in the map with the given name
-    Textures[name] = loadTextureFromFile(file, alpha);
+    return LoadTexture(DecodeImage(file), alpha, name);
+}
+
+// Uploads a decoded image, stores the texture in the Textures map and reports how long each step took.
+Texture2D ResourceManager::LoadTexture(DecodedImage image, bool alpha, std::string name)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    Textures[name] = loadTextureFromImage(image, alpha);
+    textureFiles[name] = { image.File, "", alpha };
+    std::chrono::duration<double, std::milli> upload = std::chrono::high_resolution_clock::now() - start;
+
+    std::cout << "| LOAD: texture " << name << ": decode " << image.DecodeMilliseconds << " ms, upload " << upload.count() << " ms" << std::endl;
     return Textures[name];
 }
 
+// Decodes an image file with stb_image. Only touches local state, so it is safe to call from worker threads.
+DecodedImage ResourceManager::DecodeImage(const std::string& file, int channels)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    DecodedImage image;
+    image.File = file;
+    if (readGpuTexture(file, channels, image))
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        image.DecodeMilliseconds = elapsed.count();
+        return image;
+    }
+
+    int fileChannels;
+    AssetView view;
+    if (FindAsset(file, view))
+        image.Data = stbi_load_from_memory(view.Data, static_cast<int>(view.Size), &image.Width, &image.Height, &fileChannels, channels);
+    else
+        image.Data = stbi_load(file.c_str(), &image.Width, &image.Height, &fileChannels, channels);
+    if (!image.Data)
+    {
+        std::cout << "ERROR::TEXTURE: Failed to load image " << file << std::endl;
+        image.Width = image.Height = 0;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    image.DecodeMilliseconds = elapsed.count();
+    return image;
+}
+
+// Loads every image as RGBA, packs them on shelves and uploads the result as one texture.
+Texture2D ResourceManager::LoadAtlas(const std::vector<std::pair<std::string, std::string>>& images, std::string name)
+{
+    std::vector<std::pair<DecodedImage, std::string>> decoded;
+    for (const auto& image : images)
+        decoded.emplace_back(DecodeImage(image.first, 4), image.second);
+    return LoadAtlas(decoded, name);
+}
+
+// Packs decoded RGBA images on shelves and uploads the result as one texture.
+Texture2D ResourceManager::LoadAtlas(const std::vector<std::pair<DecodedImage, std::string>>& images, std::string name)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    double decodeMilliseconds = 0.0;
+
+    // Reserve a place for each image. An image too large for the atlas is loaded as a texture of its own.
+    ShelfPacker packer(SPRITE_ATLAS_WIDTH, SPRITE_PADDING);
+    std::vector<glm::ivec2> origins(images.size());
+    std::vector<bool> packed(images.size(), false);
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        const DecodedImage& image = images[i].first;
+        if (!packer.Fits(image.Width, image.Height))
+        {
+            std::cout << "ERROR::TEXTURE: " << image.File << " (" << image.Width << "x" << image.Height << ") does not fit atlas " << name << "; loading it separately" << std::endl;
+            LoadTexture(image, true, images[i].second);
+            continue;
+        }
+        origins[i] = packer.Add(image.Width, image.Height);
+        packed[i] = true;
+        decodeMilliseconds += image.DecodeMilliseconds;
+    }
+
+    int atlasHeight = 1;
+    while (atlasHeight < packer.Height())
+    {
+        atlasHeight *= 2;
+    }
+
+    // Copy each image into the atlas and extend its border pixels into the padding,
+    // so filtering at the edge of a region never picks up a neighbouring image.
+    std::vector<unsigned char> pixels(static_cast<size_t>(SPRITE_ATLAS_WIDTH) * atlasHeight * 4, 0);
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        const DecodedImage& image = images[i].first;
+        const glm::ivec2& origin = origins[i];
+        if (!packed[i] || !image.Data)
+            continue;
+        copyPadded(image, pixels.data() + (static_cast<size_t>(origin.y - SPRITE_PADDING) * SPRITE_ATLAS_WIDTH + origin.x - SPRITE_PADDING) * 4, SPRITE_ATLAS_WIDTH);
+        releaseImage(image);
+    }
+
+    // Upload the atlas; it is only ever sampled inside the regions, so clamp to the edge.
+    Texture2D atlas;
+    atlas.Internal_Format = GL_RGBA;
+    atlas.Image_Format = GL_RGBA;
+    atlas.Wrap_S = GL_CLAMP_TO_EDGE;
+    atlas.Wrap_T = GL_CLAMP_TO_EDGE;
+    atlas.Generate(SPRITE_ATLAS_WIDTH, atlasHeight, pixels.data());
+    Textures[name] = atlas;
+
+    // Store every image as a view of the atlas.
+    glm::vec2 atlasSize(SPRITE_ATLAS_WIDTH, atlasHeight);
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        if (!packed[i])
+            continue;
+        Texture2D view = atlas;
+        view.Width = images[i].first.Width;
+        view.Height = images[i].first.Height;
+        view.Region = glm::vec4(glm::vec2(origins[i]) / atlasSize, glm::vec2(view.Width, view.Height) / atlasSize);
+        Textures[images[i].second] = view;
+        textureFiles[images[i].second] = { images[i].first.File, name, true };
+    }
+
+    std::chrono::duration<double, std::milli> build = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "| LOAD: atlas " << name << " (" << images.size() << " images): decode " << decodeMilliseconds << " ms, pack and upload " << build.count() << " ms" << std::endl;
+    return atlas;
+}
+
 // Retrieves a stored texture by its name.
 Texture2D& ResourceManager::GetTexture(std::string name)
 {
     return Textures[name];
 }
 
+// Maps the asset pack used by all loaders.
+bool ResourceManager::OpenPack(const std::string& path)
+{
+    if (!Pack.Open(path))
+        return false;
+    std::cout << "| LOAD: using asset pack " << path << std::endl;
+    return true;
+}
+
+bool ResourceManager::FindAsset(const std::string& path, AssetView& view)
+{
+    return Pack.IsOpen() && Pack.Find(PackName(path), view);
+}
+
+std::vector<std::string> ResourceManager::ListAssets(const std::string& directory)
+{
+    std::vector<std::string> names;
+    if (Pack.IsOpen())
+    {
+        std::string prefix = PackName(directory);
+        if (!prefix.empty() && prefix.back() != '/')
+            prefix += '/';
+        Pack.List(prefix, names);
+    }
+    return names;
+}
+
+// Strips the relative prefixes the game uses and lower-cases the path, matching the pack_assets tool.
+std::string ResourceManager::PackName(const std::string& path)
+{
+    size_t start = 0;
+    while (path.compare(start, 3, "../") == 0 || path.compare(start, 3, "..\\") == 0)
+        start += 3;
+    while (path.compare(start, 2, "./") == 0 || path.compare(start, 2, ".\\") == 0)
+        start += 2;
+
+    std::string name = path.substr(start);
+    for (char& c : name)
+        c = c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return name;
+}
+
+bool ResourceManager::IsPackOpen()
+{
+    return Pack.IsOpen();
+}
+
+// Changed files are matched against the files every shader and texture was loaded from.
+bool ResourceManager::Reload(const std::string& file)
+{
+    bool shaders = reloadShaders(file);
+    bool textures = reloadTextures(file);
+    return shaders || textures;
+}
+
 // Deallocates all loaded resources, including shaders and textures.
 void ResourceManager::Clear()
 {
     // Properly delete all shaders
     for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    // Properly delete all textures
+        RenderState::DeleteProgram(iter.second.ID);
+    // Properly delete all textures; images packed into an atlas share its ID, so delete each ID once
+    std::set<unsigned int> textureIDs;
     for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+        textureIDs.insert(iter.second.ID);
+    for (unsigned int id : textureIDs)
+        RenderState::DeleteTexture(id);
+    // Delete the uniform buffer shared by all shaders
+    Shader::ReleaseFrameUniforms();
+    shaderFiles.clear();
+    textureFiles.clear();
+    // Unmap the asset pack
+    Pack.Close();
 }
 
 // Helper function to load and compile a shader from file. Optionally loads a geometry shader.
-Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile)
+Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, bool wait)
 {
+    // Packed sources are NUL-terminated, so they are compiled straight from the mapped pack.
+    AssetView vertexView, fragmentView, geometryView;
+    if (FindAsset(vShaderFile, vertexView) && FindAsset(fShaderFile, fragmentView)
+        && (gShaderFile == nullptr || FindAsset(gShaderFile, geometryView)))
+    {
+        return buildProgram(vShaderFile, reinterpret_cast<const char*>(vertexView.Data), reinterpret_cast<const char*>(fragmentView.Data),
+            gShaderFile != nullptr ? reinterpret_cast<const char*>(geometryView.Data) : nullptr, wait);
+    }
+
     // Retrieve the vertex and fragment shader source code from the specified files
     std::string vertexCode;
     std::string fragmentCode;
@@ -106,13 +394,37 @@ Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char*
     const char* gShaderCode = geometryCode.c_str();
 
     // Create the shader object and compile it
+    return buildProgram(vShaderFile, vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr, wait);
+}
+
+// Warm starts link the program from its cached binary; otherwise the sources are compiled and the binary stored.
+// Unless asked to wait, a compiled program is only submitted here and finished by FinishShaders().
+Shader ResourceManager::buildProgram(const char* label, const char* vertexSource, const char* fragmentSource, const char* geometrySource, bool wait)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t key = ProgramCache::Key(vertexSource, fragmentSource, geometrySource);
+
     Shader shader;
-    shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
+    bool cached = shader.LoadBinary(key);
+    if (!cached && !wait)
+    {
+        shader.Submit(vertexSource, fragmentSource, geometrySource);
+        pendingShaders.push_back({ label, key, shader, start });
+        return shader;
+    }
+    if (!cached)
+    {
+        shader.Compile(vertexSource, fragmentSource, geometrySource);
+        ProgramCache::Store(shader.ID, key);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    std::cout << "| SHADER: " << label << ": " << (cached ? "cached binary" : "compiled") << " in " << elapsed.count() << " ms" << std::endl;
     return shader;
 }
 
-// Helper function to load a texture from a file and generate it.
-Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
+// Helper function to generate a texture from a decoded image. Frees the image data.
+Texture2D ResourceManager::loadTextureFromImage(const DecodedImage& image, bool alpha)
 {
     // Create a texture object
     Texture2D texture;
@@ -124,16 +436,207 @@ Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
         texture.Image_Format = GL_RGBA;
     }
 
-    // Load the image data using stb_image
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
-
-    // Generate the texture using the loaded image data
-    texture.Generate(width, height, data);
+    // Generate the texture using the decoded image data, with its mip chain if it has one
+    if (image.Levels.size() > 1)
+    {
+        texture.Filter_Min = GL_LINEAR_MIPMAP_LINEAR;
+        texture.Generate(image.Levels);
+    }
+    else
+        texture.Generate(image.Width, image.Height, image.Data);
 
     // Free the image data after the texture is generated
-    stbi_image_free(data);
+    releaseImage(image);
 
     return texture;
 }
 
+// Reads "<name>.gtex" for "<name>.<ext>" from the asset pack or the file system and validates its level table.
+bool ResourceManager::readGpuTexture(const std::string& file, int channels, DecodedImage& image)
+{
+    size_t extension = file.find_last_of('.');
+    size_t separator = file.find_last_of("/\\");
+    if (extension == std::string::npos || (separator != std::string::npos && extension < separator))
+        return false;
+    std::string path = file.substr(0, extension) + GPU_TEXTURE_EXTENSION;
+
+    // The levels point straight into the file: the pack stays mapped for the whole run,
+    // and a loose file is mapped for as long as a copy of the image holds the mapping.
+    std::shared_ptr<MappedFile> mapping;
+    const unsigned char* contents;
+    size_t size;
+    AssetView view;
+    if (FindAsset(path, view))
+    {
+        contents = view.Data;
+        size = view.Size;
+    }
+    else
+    {
+        mapping = std::make_shared<MappedFile>();
+        if (!mapping->Open(path))
+            return false;
+        contents = mapping->Data();
+        size = mapping->Size();
+    }
+
+    // Reject anything that does not fit the layout rather than reading past the end of the file.
+    GpuTextureHeader header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, contents, sizeof(header));
+    if (std::memcmp(header.Magic, GPU_TEXTURE_MAGIC, sizeof(header.Magic)) != 0 || header.Version != GPU_TEXTURE_VERSION
+        || (header.Channels != 3 && header.Channels != 4) || header.LevelCount == 0 || header.LevelCount > GPU_TEXTURE_MAX_LEVELS
+        || size < sizeof(header) + header.LevelCount * sizeof(GpuTextureLevel))
+    {
+        std::cout << "ERROR::TEXTURE: Invalid texture file " << path << std::endl;
+        return false;
+    }
+    if (channels != 0 && header.Channels != static_cast<uint32_t>(channels))
+    {
+        std::cout << "| LOAD: ignoring " << path << ": it has " << header.Channels << " channels, " << channels << " are needed" << std::endl;
+        return false;
+    }
+
+    std::vector<TextureLevel> levels;
+    size_t firstOffset = 0;
+    for (uint32_t i = 0; i < header.LevelCount; ++i)
+    {
+        GpuTextureLevel level;
+        std::memcpy(&level, contents + sizeof(header) + i * sizeof(level), sizeof(level));
+        if (level.Size != static_cast<uint64_t>(level.Width) * level.Height * header.Channels
+            || level.Offset > size || level.Size > size - level.Offset)
+        {
+            std::cout << "ERROR::TEXTURE: Invalid texture file " << path << std::endl;
+            return false;
+        }
+        // Each level must halve the one before it (rounding down, at least 1), or GL treats the texture as incomplete.
+        bool halves = i == 0 ? level.Width > 0 && level.Height > 0
+                             : level.Width == std::max(1u, levels.back().Width / 2) && level.Height == std::max(1u, levels.back().Height / 2);
+        if (!halves)
+        {
+            std::cout << "ERROR::TEXTURE: Invalid mip chain in texture file " << path << "; decoding the image instead" << std::endl;
+            return false;
+        }
+        if (i == 0)
+            firstOffset = static_cast<size_t>(level.Offset);
+        levels.push_back({ level.Width, level.Height, contents + level.Offset });
+    }
+
+    image.Storage = mapping;
+    image.Levels = levels;
+    image.Data = contents + firstOffset;
+    image.Width = levels[0].Width;
+    image.Height = levels[0].Height;
+    return true;
+}
+
+// Images decoded by stb_image are freed here; a mapped .gtex file is closed with the last copy of the image.
+void ResourceManager::releaseImage(const DecodedImage& image)
+{
+    if (image.Levels.empty() && image.Data)
+        stbi_image_free(const_cast<unsigned char*>(image.Data));
+}
+
+// Every pixel of the padding repeats the nearest edge pixel, so filtering at the edge of a region never picks up a neighbour.
+void ResourceManager::copyPadded(const DecodedImage& image, unsigned char* target, int targetWidth)
+{
+    for (int y = -SPRITE_PADDING; y < image.Height + SPRITE_PADDING; ++y)
+    {
+        int sourceY = std::min(std::max(y, 0), image.Height - 1);
+        unsigned char* row = target + static_cast<size_t>(y + SPRITE_PADDING) * targetWidth * 4;
+        for (int x = -SPRITE_PADDING; x < image.Width + SPRITE_PADDING; ++x)
+        {
+            int sourceX = std::min(std::max(x, 0), image.Width - 1);
+            const unsigned char* source = image.Data + (static_cast<size_t>(sourceY) * image.Width + sourceX) * 4;
+            std::copy(source, source + 4, row + static_cast<size_t>(x + SPRITE_PADDING) * 4);
+        }
+    }
+}
+
+// Relinks each shader that uses the file in place. A shader that fails to compile keeps its previous program.
+bool ResourceManager::reloadShaders(const std::string& file)
+{
+    std::string changed = PackName(file);
+    bool reloaded = false;
+    for (const auto& entry : shaderFiles)
+    {
+        const ShaderFiles& files = entry.second;
+        if (changed != PackName(files.Vertex) && changed != PackName(files.Fragment)
+            && (files.Geometry.empty() || changed != PackName(files.Geometry)))
+            continue;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::string vertexCode, fragmentCode, geometryCode;
+        if (!readTextFile(files.Vertex, vertexCode) || !readTextFile(files.Fragment, fragmentCode)
+            || (!files.Geometry.empty() && !readTextFile(files.Geometry, geometryCode)))
+        {
+            std::cout << "ERROR::SHADER: Failed to read shader files of " << entry.first << std::endl;
+            continue;
+        }
+        const char* geometrySource = files.Geometry.empty() ? nullptr : geometryCode.c_str();
+        Shader& shader = Shaders[entry.first];
+        if (!shader.Reload(vertexCode.c_str(), fragmentCode.c_str(), geometrySource))
+        {
+            std::cout << "| RELOAD: shader " << entry.first << " failed to build, keeping the previous program" << std::endl;
+            continue;
+        }
+        ProgramCache::Store(shader.ID, ProgramCache::Key(vertexCode.c_str(), fragmentCode.c_str(), geometrySource));
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        std::cout << "| RELOAD: shader " << entry.first << ": relinked in " << elapsed.count() << " ms" << std::endl;
+        reloaded = true;
+    }
+    return reloaded;
+}
+
+// Re-uploads standalone textures into their existing texture object and atlas images into their region of the atlas.
+bool ResourceManager::reloadTextures(const std::string& file)
+{
+    std::string changed = assetBase(file);
+    bool reloaded = false;
+    for (const auto& entry : textureFiles)
+    {
+        const TextureFile& source = entry.second;
+        if (changed != assetBase(source.File))
+            continue;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        Texture2D& texture = Textures[entry.first];
+        DecodedImage image = DecodeImage(source.File, source.Atlas.empty() ? 0 : 4);
+        if (!image.Data)
+            continue;
+        if (source.Atlas.empty())
+        {
+            // Generate keeps the ID, so every copy of the texture sees the new pixels.
+            std::vector<TextureLevel> levels = image.Levels;
+            if (levels.empty())
+                levels.push_back({ static_cast<unsigned int>(image.Width), static_cast<unsigned int>(image.Height), image.Data });
+            texture.Filter_Min = levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+            texture.Generate(levels);
+        }
+        else if (image.Width != static_cast<int>(texture.Width) || image.Height != static_cast<int>(texture.Height))
+        {
+            std::cout << "| RELOAD: " << source.File << " changed size; restart to repack atlas " << source.Atlas << std::endl;
+            releaseImage(image);
+            continue;
+        }
+        else
+        {
+            // Overwrite the image and its padding; the rest of the atlas is untouched.
+            const Texture2D& atlas = Textures[source.Atlas];
+            int x = static_cast<int>(std::lround(texture.Region.x * atlas.Width)) - SPRITE_PADDING;
+            int y = static_cast<int>(std::lround(texture.Region.y * atlas.Height)) - SPRITE_PADDING;
+            int width = image.Width + 2 * SPRITE_PADDING, height = image.Height + 2 * SPRITE_PADDING;
+            std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+            copyPadded(image, pixels.data(), width);
+            RenderState::BindTexture(GL_TEXTURE_2D, atlas.ID);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
+        releaseImage(image);
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        std::cout << "| RELOAD: texture " << entry.first << ": " << elapsed.count() << " ms" << std::endl;
+        reloaded = true;
+    }
+    return reloaded;
+}
@@ -9,108 +9,347 @@
 ** option) any later version.
 ******************************************************************/
 #include "shader.h"
+#include "program_cache.h"
+#include "render_state.h"
 
+#include <GLFW/glfw3.h>
+
+#include <cstring>
 #include <iostream>
 
+// GL_COMPLETION_STATUS_KHR / _ARB, which glad's 3.3 profile does not define
+const GLenum COMPLETION_STATUS = 0x91B1;
+typedef void (APIENTRYP MaxShaderCompilerThreadsFunction)(GLuint count);
+
+unsigned int Shader::frameUBO = 0;
+bool Shader::parallelCompile = false;
+
 Shader& Shader::Use()
 {
-    glUseProgram(this->ID);
+    RenderState::UseProgram(this->ID);
     return *this;
 }
 
 void Shader::Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
 {
-    unsigned int sVertex, sFragment, gShader;
-    // vertex Shader
-    sVertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(sVertex, 1, &vertexSource, NULL);
-    glCompileShader(sVertex);
-    checkCompileErrors(sVertex, "VERTEX");
-    // fragment Shader
-    sFragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(sFragment, 1, &fragmentSource, NULL);
-    glCompileShader(sFragment);
-    checkCompileErrors(sFragment, "FRAGMENT");
-    // if geometry shader source code is given, also compile geometry shader
-    if (geometrySource != nullptr)
+    this->Submit(vertexSource, fragmentSource, geometrySource);
+    this->Finish();
+}
+
+void Shader::Submit(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
+{
+    // the uniform table is created now, so copies taken before linking finishes see the reflected uniforms
+    this->uniforms = std::make_shared<UniformTable>();
+    this->state = std::make_shared<ProgramState>();
+    const char* sources[3] = { vertexSource, fragmentSource, geometrySource };
+    const GLenum types[3] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    // compile each stage; errors are only queried in Finish(), since querying waits for the compiler
+    for (int i = 0; i < 3; ++i)
     {
-        gShader = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(gShader, 1, &geometrySource, NULL);
-        glCompileShader(gShader);
-        checkCompileErrors(gShader, "GEOMETRY");
+        if (sources[i] == nullptr)
+            continue;
+        unsigned int stage = glCreateShader(types[i]);
+        glShaderSource(stage, 1, &sources[i], NULL);
+        glCompileShader(stage);
+        this->state->Stages[this->state->StageCount++] = stage;
     }
     // shader program
     this->ID = glCreateProgram();
-    glAttachShader(this->ID, sVertex);
-    glAttachShader(this->ID, sFragment);
-    if (geometrySource != nullptr)
-        glAttachShader(this->ID, gShader);
+    for (unsigned int i = 0; i < this->state->StageCount; ++i)
+        glAttachShader(this->ID, this->state->Stages[i]);
+    ProgramCache::MarkRetrievable(this->ID);
     glLinkProgram(this->ID);
+}
+
+bool Shader::IsReady()
+{
+    if (!this->state || this->state->Linked)
+        return true;
+    if (parallelCompile)
+    {
+        int complete = GL_FALSE;
+        glGetProgramiv(this->ID, COMPLETION_STATUS, &complete);
+        if (!complete)
+            return false;
+    }
+    this->Finish();
+    return true;
+}
+
+void Shader::Finish()
+{
+    if (!this->state || this->state->Linked)
+        return;
+    static const char* const stageNames[3] = { "VERTEX", "FRAGMENT", "GEOMETRY" };
+    for (unsigned int i = 0; i < this->state->StageCount; ++i)
+        checkCompileErrors(this->state->Stages[i], stageNames[i]);
     checkCompileErrors(this->ID, "PROGRAM");
+    this->setupLinkedProgram();
     // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(sVertex);
-    glDeleteShader(sFragment);
-    if (geometrySource != nullptr)
-        glDeleteShader(gShader);
+    for (unsigned int i = 0; i < this->state->StageCount; ++i)
+        glDeleteShader(this->state->Stages[i]);
+    this->state->Linked = true;
+    ++this->state->Revision;
+}
+
+bool Shader::InitParallelCompile()
+{
+    int extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (int i = 0; i < extensionCount && !parallelCompile; ++i)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        parallelCompile = std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0
+            || std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0;
+    }
+    if (!parallelCompile)
+        return false;
+    // let the driver use as many compiler threads as it likes
+    MaxShaderCompilerThreadsFunction maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    if (maxThreads == nullptr)
+        maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    if (maxThreads != nullptr)
+        maxThreads(0xFFFFFFFF);
+    return true;
+}
+
+bool Shader::LoadBinary(uint64_t key)
+{
+    this->state = std::make_shared<ProgramState>();
+    this->ID = glCreateProgram();
+    if (!ProgramCache::Load(this->ID, key))
+    {
+        glDeleteProgram(this->ID);
+        this->ID = 0;
+        return false;
+    }
+    this->setupLinkedProgram();
+    this->state->Linked = true;
+    this->state->Revision = 1;
+    return true;
+}
+
+bool Shader::Reload(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
+{
+    if (!this->state)
+        return false;
+    this->Finish();
+    static const char* const stageNames[3] = { "VERTEX", "FRAGMENT", "GEOMETRY" };
+    const char* sources[3] = { vertexSource, fragmentSource, geometrySource };
+    const GLenum types[3] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    unsigned int stages[3];
+    unsigned int stageCount = 0;
+    bool compiled = true;
+    for (int i = 0; i < 3; ++i)
+    {
+        if (sources[i] == nullptr)
+            continue;
+        unsigned int stage = glCreateShader(types[i]);
+        glShaderSource(stage, 1, &sources[i], NULL);
+        glCompileShader(stage);
+        compiled = checkCompileErrors(stage, stageNames[i]) && compiled;
+        stages[stageCount++] = stage;
+    }
+
+    // link a scratch program first, so a broken edit never leaves the live program unlinked
+    bool linked = false;
+    if (compiled)
+    {
+        unsigned int scratch = glCreateProgram();
+        for (unsigned int i = 0; i < stageCount; ++i)
+            glAttachShader(scratch, stages[i]);
+        glLinkProgram(scratch);
+        linked = checkCompileErrors(scratch, "PROGRAM");
+        glDeleteProgram(scratch);
+    }
+
+    // swap the stages of the live program; relinking keeps the ID held by every copy and renderer
+    if (linked)
+    {
+        GLuint attached[3];
+        GLsizei attachedCount = 0;
+        glGetAttachedShaders(this->ID, 3, &attachedCount, attached);
+        for (GLsizei i = 0; i < attachedCount; ++i)
+            glDetachShader(this->ID, attached[i]);
+        for (unsigned int i = 0; i < stageCount; ++i)
+            glAttachShader(this->ID, stages[i]);
+        ProgramCache::MarkRetrievable(this->ID);
+        glLinkProgram(this->ID);
+        linked = checkCompileErrors(this->ID, "PROGRAM");
+        this->setupLinkedProgram();
+        ++this->state->Revision;
+    }
+    // stages still attached are only flagged and go away with the next reload
+    for (unsigned int i = 0; i < stageCount; ++i)
+        glDeleteShader(stages[i]);
+    return linked;
+}
+
+void Shader::setupLinkedProgram()
+{
+    // resolve uniform locations once and attach the shared per-frame block, if the program uses it
+    this->reflectUniforms();
+    unsigned int frameBlock = glGetUniformBlockIndex(this->ID, "Frame");
+    if (frameBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(this->ID, frameBlock, FRAME_UNIFORM_BINDING);
 }
 
 void Shader::SetFloat(const char* name, float value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform1f(glGetUniformLocation(this->ID, name), value);
+    glUniform1f(this->GetUniformLocation(name), value);
 }
 void Shader::SetInteger(const char* name, int value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform1i(glGetUniformLocation(this->ID, name), value);
+    glUniform1i(this->GetUniformLocation(name), value);
 }
 void Shader::SetVector2f(const char* name, float x, float y, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+    glUniform2f(this->GetUniformLocation(name), x, y);
 }
 void Shader::SetVector2f(const char* name, const glm::vec2& value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+    glUniform2f(this->GetUniformLocation(name), value.x, value.y);
 }
 void Shader::SetVector3f(const char* name, float x, float y, float z, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+    glUniform3f(this->GetUniformLocation(name), x, y, z);
 }
 void Shader::SetVector3f(const char* name, const glm::vec3& value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+    glUniform3f(this->GetUniformLocation(name), value.x, value.y, value.z);
 }
 void Shader::SetVector4f(const char* name, float x, float y, float z, float w, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+    glUniform4f(this->GetUniformLocation(name), x, y, z, w);
 }
 void Shader::SetVector4f(const char* name, const glm::vec4& value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+    glUniform4f(this->GetUniformLocation(name), value.x, value.y, value.z, value.w);
 }
 void Shader::SetMatrix4(const char* name, const glm::mat4& matrix, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+    glUniformMatrix4fv(this->GetUniformLocation(name), 1, false, glm::value_ptr(matrix));
+}
+
+
+void Shader::SetFloat(int location, float value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    glUniform1f(location, value);
+}
+void Shader::SetInteger(int location, int value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    glUniform1i(location, value);
+}
+void Shader::SetVector2f(int location, const glm::vec2& value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    glUniform2f(location, value.x, value.y);
+}
+void Shader::SetVector3f(int location, const glm::vec3& value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    glUniform3f(location, value.x, value.y, value.z);
+}
+void Shader::SetVector4f(int location, const glm::vec4& value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    glUniform4f(location, value.x, value.y, value.z, value.w);
+}
+void Shader::SetMatrix4(int location, const glm::mat4& matrix, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    glUniformMatrix4fv(location, 1, false, glm::value_ptr(matrix));
 }
 
+int Shader::GetUniformLocation(const char* name) const
+{
+    // programs only have a handful of uniforms, so a linear scan beats hashing the name
+    if (this->uniforms)
+    {
+        for (const auto& uniform : *this->uniforms)
+        {
+            if (std::strcmp(uniform.first.c_str(), name) == 0)
+                return uniform.second;
+        }
+    }
+    return -1;
+}
+
+void Shader::UpdateFrameUniforms(const glm::mat4& projection)
+{
+    // create the shared buffer on first use and keep it bound to the frame binding point
+    if (frameUBO == 0)
+    {
+        glGenBuffers(1, &frameUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameUBO);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projection));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Shader::ReleaseFrameUniforms()
+{
+    glDeleteBuffers(1, &frameUBO);
+    frameUBO = 0;
+}
+
+void Shader::reflectUniforms()
+{
+    // fill the existing table in place, so copies taken before linking finished see the uniforms too
+    if (!this->uniforms)
+        this->uniforms = std::make_shared<UniformTable>();
+    this->uniforms->clear();
+    int count = 0, maxLength = 0;
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength > 0 ? maxLength : 1);
+    for (int i = 0; i < count; ++i)
+    {
+        int length = 0, size = 0;
+        GLenum type;
+        glGetActiveUniform(this->ID, i, maxLength, &length, &size, &type, name.data());
+        std::string uniformName(name.data(), length);
+        int location = glGetUniformLocation(this->ID, uniformName.c_str());
+        // members of uniform blocks have no location of their own
+        if (location < 0)
+            continue;
+        // arrays are reported as "name[0]"; also register the plain name
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            this->uniforms->emplace_back(uniformName.substr(0, uniformName.size() - 3), location);
+        this->uniforms->emplace_back(uniformName, location);
+    }
+}
 
-void Shader::checkCompileErrors(unsigned int object, std::string type)
+bool Shader::checkCompileErrors(unsigned int object, std::string type)
 {
     int success;
     char infoLog[1024];
@@ -136,5 +375,6 @@ void Shader::checkCompileErrors(unsigned int object, std::string type)
                 << std::endl;
         }
     }
+    return success != 0;
 }
 
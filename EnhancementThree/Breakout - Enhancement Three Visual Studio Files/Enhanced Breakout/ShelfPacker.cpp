@@ -0,0 +1,45 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "shelf_packer.h"
+
+#include <algorithm>
+
+
+ShelfPacker::ShelfPacker(int width, int padding)
+    : width(width), padding(padding), penX(padding), penY(padding), shelfHeight(0)
+{
+}
+
+bool ShelfPacker::Fits(int width, int height) const
+{
+    // Keeping rectangles no taller than the atlas is wide keeps the atlas roughly square.
+    return width + 2 * this->padding <= this->width && height + 2 * this->padding <= this->width;
+}
+
+glm::ivec2 ShelfPacker::Add(int width, int height)
+{
+    // Start a new shelf when the rectangle does not fit on the current one.
+    if (this->penX + width + this->padding > this->width)
+    {
+        this->penX = this->padding;
+        this->penY += this->shelfHeight + this->padding;
+        this->shelfHeight = 0;
+    }
+    glm::ivec2 origin(this->penX, this->penY);
+    this->penX += width + this->padding;
+    this->shelfHeight = std::max(this->shelfHeight, height);
+    return origin;
+}
+
+int ShelfPacker::Height() const
+{
+    return this->penY + this->shelfHeight + this->padding;
+}
@@ -9,23 +9,64 @@
 
 
 #include "sprite_renderer.h"
+#include "render_state.h"
 
-// Constructor that initializes the shader and sets up the necessary render data.
-SpriteRenderer::SpriteRenderer(Shader& shader)
+#include <cstddef>
+
+// Constructor that initializes the shaders and sets up the necessary render data.
+SpriteRenderer::SpriteRenderer(Shader& shader, Shader& batchShader)
 {
-    this->shader = shader;  // Store the provided shader.
+    this->shader = shader;            // Store the provided shaders.
+    this->batchShader = batchShader;
+    this->configureShader();
     this->initRenderData();  // Initialize the vertex array and buffer for rendering.
 }
 
+// Resolves the uniform locations used for single sprites.
+void SpriteRenderer::configureShader()
+{
+    this->modelLocation = this->shader.GetUniformLocation("model");
+    this->colorLocation = this->shader.GetUniformLocation("spriteColor");
+    this->regionLocation = this->shader.GetUniformLocation("region");
+    this->shaderRevision = this->shader.Revision();
+}
+
 // Destructor that cleans up any OpenGL resources associated with the sprite renderer.
 SpriteRenderer::~SpriteRenderer()
 {
-    glDeleteVertexArrays(1, &this->quadVAO);   // Delete the VAO (vertex array object).
+    RenderState::DeleteVertexArray(this->quadVAO);   // Delete the VAO (vertex array object).
+    RenderState::DeleteVertexArray(this->instanceVAO);
+    RenderState::DeleteBuffer(this->quadVBO);
+    RenderState::DeleteBuffer(this->instanceVBO);
 }
 
 // Function to draw a textured sprite with transformations applied (position, rotation, scale).
 void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
 {
+    // While batching, only record the sprite; the transform is built on the GPU.
+    if (this->batching)
+    {
+        SpriteInstance instance;
+        instance.Position = position;
+        instance.Size = size;
+        instance.Color = glm::vec4(color, 1.0f);
+        instance.Rotation = rotate;
+        instance.Region = texture.Region;
+        instance.TextureIndex = this->textureIndex(texture);
+        this->instances.push_back(instance);
+        return;
+    }
+
+    // Skip the sprite until its program has linked.
+    if (!this->shader.IsReady())
+    {
+        return;
+    }
+    if (this->shader.Revision() != this->shaderRevision)
+    {
+        this->configureShader();
+    }
+
     // Use the shader for rendering.
     this->shader.Use();
 
@@ -44,26 +85,142 @@ void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position, glm::vec
     model = glm::scale(model, glm::vec3(size, 1.0f)); // Last scale.
 
     // Pass the model matrix to the shader.
-    this->shader.SetMatrix4("model", model);
+    this->shader.SetMatrix4(this->modelLocation, model);
 
     // Set the sprite color in the shader.
-    this->shader.SetVector3f("spriteColor", color);
+    this->shader.SetVector3f(this->colorLocation, color);
+
+    // Select the image's region of its texture.
+    this->shader.SetVector4f(this->regionLocation, texture.Region);
 
     // Bind the texture to texture unit 0 and set up the VAO for rendering.
-    glActiveTexture(GL_TEXTURE0);
+    RenderState::ActiveTexture(GL_TEXTURE0);
     texture.Bind();
 
     // Render the sprite using the prepared VAO.
-    glBindVertexArray(this->quadVAO);
+    RenderState::BindVertexArray(this->quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+}
+
+// Opens a new batch. Sprites are recorded until Flush() or End() is called.
+void SpriteRenderer::Begin()
+{
+    this->batching = true;
+}
+
+// Uploads the recorded sprites grouped by texture and draws each group with a single instanced call.
+void SpriteRenderer::Flush()
+{
+    if (this->instances.empty())
+    {
+        return;
+    }
+    if (!this->batchShader.IsReady())
+    {
+        this->instances.clear();
+        this->textures.clear();
+        return;
+    }
+
+    // Counting sort of the instances by texture index. Submission order is kept within each group.
+    size_t textureCount = this->textures.size();
+    this->textureOffsets.assign(textureCount + 1, 0);
+    for (const SpriteInstance& instance : this->instances)
+    {
+        ++this->textureOffsets[instance.TextureIndex + 1];
+    }
+    for (size_t i = 1; i <= textureCount; ++i)
+    {
+        this->textureOffsets[i] += this->textureOffsets[i - 1];
+    }
+    this->sortedInstances.resize(this->instances.size());
+    for (const SpriteInstance& instance : this->instances)
+    {
+        this->sortedInstances[this->textureOffsets[instance.TextureIndex]++] = instance;
+    }
+
+    // Upload the instance data, growing the buffer if the batch no longer fits.
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    if (this->sortedInstances.size() > this->instanceCapacity)
+    {
+        this->instanceCapacity = this->sortedInstances.size() * 2;
+        glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * sizeof(SpriteInstance), NULL, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->sortedInstances.size() * sizeof(SpriteInstance), this->sortedInstances.data());
+
+    this->batchShader.Use();
+    RenderState::ActiveTexture(GL_TEXTURE0);
+    RenderState::BindVertexArray(this->instanceVAO);
+
+    // After the scatter above, textureOffsets[i] holds the end of group i.
+    size_t first = 0;
+    for (size_t i = 0; i < textureCount; ++i)
+    {
+        size_t last = this->textureOffsets[i];
+        if (last > first)
+        {
+            this->setInstanceOffset(first * sizeof(SpriteInstance));
+            this->textures[i].Bind();
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(last - first));
+        }
+        first = last;
+    }
+
+    this->instances.clear();
+    this->textures.clear();
+}
+
+// Flushes any recorded sprites and closes the batch.
+void SpriteRenderer::End()
+{
+    this->Flush();
+    this->batching = false;
+}
+
+// Creates a vertex array combining the sprite quad with instances stored in an external buffer.
+unsigned int SpriteRenderer::CreateInstanceArray(unsigned int buffer, size_t firstInstance)
+{
+    unsigned int vao;
+    glGenVertexArrays(1, &vao);
+    RenderState::BindVertexArray(vao);
+
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (unsigned int attribute = 1; attribute <= 5; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    this->setInstanceOffset(firstInstance * sizeof(SpriteInstance));
+    return vao;
+}
+
+// Draws instances that already live on the GPU with a single instanced call.
+void SpriteRenderer::DrawInstances(unsigned int vao, Texture2D& texture, size_t count)
+{
+    if (this->batching)
+    {
+        this->Flush();
+    }
+    if (count == 0 || !this->batchShader.IsReady())
+    {
+        return;
+    }
+
+    this->batchShader.Use();
+    RenderState::ActiveTexture(GL_TEXTURE0);
+    texture.Bind();
+    RenderState::BindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(count));
 }
 
 // Private function to initialize the vertex array and buffer for the sprite quad.
 void SpriteRenderer::initRenderData()
 {
     // Define the vertex data for a sprite quad (2 triangles).
-    unsigned int VBO;
     float vertices[] = {
         // Vertex positions and texture coordinates.
         // pos      // tex 
@@ -78,19 +235,56 @@ void SpriteRenderer::initRenderData()
 
     // Generate and configure VAO and VBO.
     glGenVertexArrays(1, &this->quadVAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &this->quadVBO);
 
     // Bind and fill the buffer with vertex data.
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     // Set up the vertex array object (VAO).
-    glBindVertexArray(this->quadVAO);
+    RenderState::BindVertexArray(this->quadVAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    // Unbind the VAO after setup.
-    glBindVertexArray(0);
+    // Set up the instanced VAO: the same quad plus per-instance attributes read from the instance buffer.
+    glGenVertexArrays(1, &this->instanceVAO);
+    glGenBuffers(1, &this->instanceVBO);
+    RenderState::BindVertexArray(this->instanceVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    for (unsigned int attribute = 1; attribute <= 5; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);  // Advance once per instance instead of once per vertex.
+    }
+    this->setInstanceOffset(0);
+}
+
+// Points the instance attributes (position, size, color, rotation, region) at the given offset of the
+// instance buffer. Expects the instance VAO and instance buffer to be bound.
+void SpriteRenderer::setInstanceOffset(size_t offset)
+{
+    GLsizei stride = sizeof(SpriteInstance);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(SpriteInstance, Position)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(SpriteInstance, Size)));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(SpriteInstance, Color)));
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(SpriteInstance, Rotation)));
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(SpriteInstance, Region)));
+}
+
+// Returns the index of the texture in the batch's texture table, appending it if it is not there yet.
+unsigned int SpriteRenderer::textureIndex(const Texture2D& texture)
+{
+    for (unsigned int i = 0; i < this->textures.size(); ++i)
+    {
+        if (this->textures[i].ID == texture.ID)
+        {
+            return i;
+        }
+    }
+    this->textures.push_back(texture);
+    return static_cast<unsigned int>(this->textures.size() - 1);
 }
 
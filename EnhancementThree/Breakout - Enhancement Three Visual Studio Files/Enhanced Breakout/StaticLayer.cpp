@@ -0,0 +1,83 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "static_layer.h"
+#include "render_state.h"
+
+#include <iostream>
+
+
+// Deletes the framebuffer and its color texture.
+StaticLayer::~StaticLayer()
+{
+    glDeleteFramebuffers(1, &this->fbo);
+    RenderState::DeleteTexture(this->colorTexture);
+}
+
+bool StaticLayer::IsCurrent(unsigned int generation, unsigned int width, unsigned int height) const
+{
+    return this->valid && this->generation == generation && this->width == width && this->height == height;
+}
+
+// Binds the layer's framebuffer and clears it; the caller then draws the static content.
+void StaticLayer::Begin(unsigned int generation, unsigned int width, unsigned int height)
+{
+    if (this->fbo == 0 || this->width != width || this->height != height)
+    {
+        this->allocate(width, height);
+    }
+    this->generation = generation;
+    this->valid = true;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void StaticLayer::End()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, this->width, this->height);
+}
+
+// Copies the cached layer into the default framebuffer, replacing its content.
+void StaticLayer::Blit() const
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, this->width, this->height, 0, 0, this->width, this->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void StaticLayer::allocate(unsigned int width, unsigned int height)
+{
+    this->width = width;
+    this->height = height;
+
+    if (this->fbo == 0)
+    {
+        glGenFramebuffers(1, &this->fbo);
+        glGenTextures(1, &this->colorTexture);
+    }
+
+    RenderState::BindTexture(GL_TEXTURE_2D, this->colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->colorTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::STATIC_LAYER: Framebuffer is not complete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -7,66 +7,152 @@
 ** option) any later version.
 ******************************************************************/
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 
-#include <glm/gtc/matrix_transform.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include "text_renderer.h"
 #include "resource_manager.h"
+#include "render_state.h"
+#include "shelf_packer.h"
 
-// Constructor: Initializes the text renderer with a screen width and height.
-TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+// Constructor: Initializes the text renderer shader.
+// The projection comes from the shared "Frame" uniform block, which the game updates.
+TextRenderer::TextRenderer()
 {
 	// Load and configure the text renderer shader for 2D rendering.
 	this->TextShader = ResourceManager::LoadShader("../shaders/text_2d.vs", "../shaders/text_2d.fs", nullptr, "text");
-	this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
-	this->TextShader.SetInteger("text", 0);
-
-    // Configure the Vertex Array Object (VAO) and Vertex Buffer Object (VBO) for rendering texture quads.
-    glGenVertexArrays(1, &this->VAO);
-    glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindVertexArray(0);
-}
-
-// Loads a font and generates textures for each character.
+	this->configureShader();
+}
+
+// Binds the glyph atlas sampler to unit 0 and resolves the per-draw uniform locations.
+void TextRenderer::configureShader()
+{
+	this->TextShader.SetInteger("text", 0, true);
+	this->colorLocation = this->TextShader.GetUniformLocation("textColor");
+	this->offsetLocation = this->TextShader.GetUniformLocation("offset");
+	this->shaderRevision = this->TextShader.Revision();
+}
+
+// Destructor: Releases the glyph atlas and every cached layout.
+TextRenderer::~TextRenderer()
+{
+    this->clearLayouts();
+    RenderState::DeleteTexture(this->AtlasTexture);
+}
+
+// Atlas layout
+const int ATLAS_WIDTH = 512;   // Width of the glyph atlas in pixels
+const int GLYPH_PADDING = 1;   // Empty pixels around each glyph to prevent sampling neighbours
+
+// Glyph cache file layout: GlyphCacheHeader, GlyphCacheEntry[GlyphCount], then the
+// Width * Height atlas pixels. Bump the version when the atlas layout above changes.
+const char     GLYPH_CACHE_MAGIC[4] = { 'B', 'K', 'G', 'C' };
+const uint32_t GLYPH_CACHE_VERSION = 1;
+const char* const GLYPH_CACHE_EXTENSION = ".glyphs";
+
+// Prefix of glyph cache file paths, set by SetCacheDirectory
+static std::string cacheDirectory;
+
+struct GlyphCacheHeader {
+    char     Magic[4];
+    uint32_t Version;
+    uint64_t FontHash;    // Hash of the font file contents
+    uint32_t FontSize;
+    uint32_t GlyphCount;
+    uint32_t Width, Height;
+};
+
+struct GlyphCacheEntry {
+    int32_t  Size[2];
+    int32_t  Bearing[2];
+    uint32_t Advance;
+    uint32_t Loaded;
+    float    UVMin[2];
+    float    UVMax[2];
+};
+
+// 64-bit FNV-1a over the font file, so an edited font invalidates its cache
+static uint64_t hashBytes(const unsigned char* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+// Glyph caches are kept next to the executable rather than wherever the game is started from.
+void TextRenderer::SetCacheDirectory(const std::string& directory)
+{
+    cacheDirectory = directory;
+}
+
+// Loads a font and packs every character into a single atlas texture.
 void TextRenderer::Load(const std::string& font, unsigned int fontSize)
 {
-    // Clear previously loaded characters.
-    this->Characters.clear();
+    this->Load(Rasterize(font, fontSize));
+}
+
+// Rasterizes the first 128 ASCII characters of a font and packs them into an atlas image.
+// Uses its own FreeType library instance, so it may run on any thread.
+FontAtlas TextRenderer::Rasterize(const std::string& font, unsigned int fontSize)
+{
+    FontAtlas result;
+
+    // Read the font once: its hash identifies the glyph cache, and on a miss FreeType
+    // rasterizes from the same bytes. Packed fonts are used straight from the pack.
+    std::vector<unsigned char> fontFile;
+    AssetView fontData;
+    if (!ResourceManager::FindAsset(font, fontData))
+    {
+        std::ifstream input(font, std::ios::binary);
+        if (!input)
+        {
+            std::cerr << "ERROR::FREETYPE: Failed to load font" << std::endl;
+            return result;
+        }
+        fontFile.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        fontData.Data = fontFile.data();
+        fontData.Size = fontFile.size();
+    }
+    uint64_t fontHash = hashBytes(fontData.Data, fontData.Size);
+    std::string cacheFile = cacheDirectory + font.substr(font.find_last_of("/\\") + 1) + "." + std::to_string(fontSize) + GLYPH_CACHE_EXTENSION;
+    if (readGlyphCache(cacheFile, fontHash, fontSize, result))
+    {
+        std::cout << "| LOAD: font " << font << ": glyphs read from " << cacheFile << std::endl;
+        return result;
+    }
 
     // Initialize and load FreeType library
     FT_Library ft;
     if (FT_Init_FreeType(&ft))
     {
         std::cerr << "ERROR::FREETYPE: Could not initialize the FreeType Library" << std::endl;
-        return;
+        return result;
     }
 
-    // Load the font face from the specified file.
+    // Load the font face from the bytes read above.
     FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
+    if (FT_New_Memory_Face(ft, fontData.Data, static_cast<FT_Long>(fontData.Size), 0, &face))
     {
         std::cerr << "ERROR::FREETYPE: Failed to load font" << std::endl;
         FT_Done_FreeType(ft);
-        return;
+        return result;
     }
 
     // Set the font size for rendering.
     FT_Set_Pixel_Sizes(face, 0, fontSize);
 
-    // Disable byte-alignment restriction to ensure correct texture data.
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    // Load the first 128 ASCII characters and create a texture for each one.
-    for (GLubyte c = 0; c < 128; ++c)
+    // Rasterize the first 128 ASCII characters and place them on shelves in the atlas.
+    std::vector<std::vector<unsigned char>> bitmaps(GLYPH_COUNT);
+    std::vector<glm::ivec2> origins(GLYPH_COUNT);
+    ShelfPacker packer(ATLAS_WIDTH, GLYPH_PADDING);
+    for (unsigned int c = 0; c < GLYPH_COUNT; ++c)
     {
         // Load character glyph.
         if (FT_Load_Char(face, c, FT_LOAD_RENDER))
@@ -75,96 +161,188 @@ void TextRenderer::Load(const std::string& font, unsigned int fontSize)
             continue;
         }
 
-        // Generate a texture for the character.
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        // Set texture parameters for wrapping and filtering.
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        int width = static_cast<int>(face->glyph->bitmap.width);
+        int rows = static_cast<int>(face->glyph->bitmap.rows);
+        origins[c] = packer.Add(width, rows);
+
+        // Keep a tightly packed copy of the bitmap until the atlas size is known.
+        bitmaps[c].resize(static_cast<size_t>(width) * rows);
+        for (int row = 0; row < rows; ++row)
+        {
+            const unsigned char* source = face->glyph->bitmap.buffer + row * face->glyph->bitmap.pitch;
+            std::copy(source, source + width, bitmaps[c].begin() + static_cast<size_t>(row) * width);
+        }
 
         // Store the character information for future rendering.
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<unsigned int>(face->glyph->advance.x)
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
+        Character& character = result.Characters[c];
+        character.Size = glm::ivec2(width, rows);
+        character.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+        character.Advance = static_cast<unsigned int>(face->glyph->advance.x);
+        character.Loaded = true;
     }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-
     // Clean up FreeType resources after loading the font.
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
-}
-
-// Renders text at a specified position, scale, and color.
-void TextRenderer::RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color) 
-{
-    // Activate the shader program and set the text color.
-    this->TextShader.Use();
-    this->TextShader.SetVector3f("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
 
-    // Loop through each character in the text string.
-    for (char c : text)
+    // Copy every glyph into the atlas image and compute its texture coordinates.
+    result.Width = ATLAS_WIDTH;
+    result.Height = 1;
+    while (result.Height < packer.Height())
     {
-        // Skip characters that aren't available.
-        if (Characters.find(c) == Characters.end())
+        result.Height *= 2;
+    }
+    result.Pixels.assign(static_cast<size_t>(result.Width) * result.Height, 0);
+    for (unsigned int c = 0; c < GLYPH_COUNT; ++c)
+    {
+        Character& character = result.Characters[c];
+        if (!character.Loaded)
         {
             continue;
         }
+        for (int row = 0; row < character.Size.y; ++row)
+        {
+            std::copy(bitmaps[c].begin() + static_cast<size_t>(row) * character.Size.x,
+                bitmaps[c].begin() + static_cast<size_t>(row + 1) * character.Size.x,
+                result.Pixels.begin() + static_cast<size_t>(origins[c].y + row) * result.Width + origins[c].x);
+        }
+        character.UVMin = glm::vec2(origins[c]) / glm::vec2(result.Width, result.Height);
+        character.UVMax = glm::vec2(origins[c] + character.Size) / glm::vec2(result.Width, result.Height);
+    }
 
-        Character ch = Characters[c];
+    writeGlyphCache(cacheFile, fontHash, fontSize, result);
+    return result;
+}
 
-        // Calculate the position and size of the character quad.
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
+// Reads the glyph cache if it was written for exactly this font file, size and character set.
+bool TextRenderer::readGlyphCache(const std::string& file, uint64_t fontHash, unsigned int fontSize, FontAtlas& atlas)
+{
+    std::ifstream input(file, std::ios::binary);
+    GlyphCacheHeader header;
+    if (!input || !input.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+    if (std::memcmp(header.Magic, GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC)) != 0 || header.Version != GLYPH_CACHE_VERSION
+        || header.FontHash != fontHash || header.FontSize != fontSize || header.GlyphCount != GLYPH_COUNT
+        || header.Width != static_cast<uint32_t>(ATLAS_WIDTH) || header.Height == 0 || header.Height > 4096)
+        return false;
+
+    std::vector<GlyphCacheEntry> entries(GLYPH_COUNT);
+    std::vector<unsigned char> pixels(static_cast<size_t>(header.Width) * header.Height);
+    if (!input.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(GlyphCacheEntry))
+        || !input.read(reinterpret_cast<char*>(pixels.data()), pixels.size()))
+        return false;
+
+    for (unsigned int c = 0; c < GLYPH_COUNT; ++c)
+    {
+        const GlyphCacheEntry& entry = entries[c];
+        Character& character = atlas.Characters[c];
+        character.Size = glm::ivec2(entry.Size[0], entry.Size[1]);
+        character.Bearing = glm::ivec2(entry.Bearing[0], entry.Bearing[1]);
+        character.Advance = entry.Advance;
+        character.UVMin = glm::vec2(entry.UVMin[0], entry.UVMin[1]);
+        character.UVMax = glm::vec2(entry.UVMax[0], entry.UVMax[1]);
+        character.Loaded = entry.Loaded != 0;
+    }
+    atlas.Pixels.swap(pixels);
+    atlas.Width = static_cast<int>(header.Width);
+    atlas.Height = static_cast<int>(header.Height);
+    return true;
+}
 
-        // Define the vertices for the character quad.
-        float vertices[6][4] = {
-            { xpos,     ypos + h,  0.0f, 1.0f },
-            { xpos + w, ypos,      1.0f, 0.0f },
-            { xpos,     ypos,      0.0f, 0.0f },
-
-            { xpos,     ypos + h,  0.0f, 1.0f },
-            { xpos + w, ypos + h,  1.0f, 1.0f },
-            { xpos + w, ypos,      1.0f, 0.0f }
-        };
+// Writes the metrics of every glyph followed by the atlas image.
+void TextRenderer::writeGlyphCache(const std::string& file, uint64_t fontHash, unsigned int fontSize, const FontAtlas& atlas)
+{
+    if (atlas.Pixels.empty())
+        return;
 
-        // Bind the texture for the character and update the VBO.
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+    GlyphCacheHeader header;
+    std::memcpy(header.Magic, GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC));
+    header.Version = GLYPH_CACHE_VERSION;
+    header.FontHash = fontHash;
+    header.FontSize = fontSize;
+    header.GlyphCount = GLYPH_COUNT;
+    header.Width = static_cast<uint32_t>(atlas.Width);
+    header.Height = static_cast<uint32_t>(atlas.Height);
+
+    std::vector<GlyphCacheEntry> entries(GLYPH_COUNT);
+    for (unsigned int c = 0; c < GLYPH_COUNT; ++c)
+    {
+        const Character& character = atlas.Characters[c];
+        GlyphCacheEntry& entry = entries[c];
+        entry.Size[0] = character.Size.x;
+        entry.Size[1] = character.Size.y;
+        entry.Bearing[0] = character.Bearing.x;
+        entry.Bearing[1] = character.Bearing.y;
+        entry.Advance = character.Advance;
+        entry.Loaded = character.Loaded ? 1 : 0;
+        entry.UVMin[0] = character.UVMin.x;
+        entry.UVMin[1] = character.UVMin.y;
+        entry.UVMax[0] = character.UVMax.x;
+        entry.UVMax[1] = character.UVMax.y;
+    }
 
-        // Render the quad.
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+    std::ofstream output(file, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(GlyphCacheEntry));
+    output.write(reinterpret_cast<const char*>(atlas.Pixels.data()), atlas.Pixels.size());
+    if (!output)
+        std::cerr << "ERROR::FREETYPE: Failed to write glyph cache " << file << std::endl;
+}
 
-        // Advance the cursor to the next character.
-        x += (ch.Advance >> 6) * scale; // Convert to pixels.
+// Replaces the current font with a rasterized one and uploads its atlas.
+void TextRenderer::Load(const FontAtlas& atlas)
+{
+    // Clear previously loaded characters and the layouts built from them.
+    this->Characters = atlas.Characters;
+    this->clearLayouts();
+    ++this->font;
+    if (this->AtlasTexture != 0)
+    {
+        RenderState::DeleteTexture(this->AtlasTexture);
+        this->AtlasTexture = 0;
+    }
+    if (atlas.Pixels.empty())
+    {
+        return;
     }
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Disable byte-alignment restriction to ensure correct texture data.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Upload the atlas as a single-channel texture.
+    glGenTextures(1, &this->AtlasTexture);
+    RenderState::BindTexture(GL_TEXTURE_2D, this->AtlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas.Width, atlas.Height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.Pixels.data());
+
+    // Set texture parameters for wrapping and filtering.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+// Renders text at a specified position, scale, and color.
+// The string's quads come from the layout cache, so a repeated string costs one bind and one draw.
+void TextRenderer::RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color) 
+{
+    const TextLayout& layout = this->layout(text, scale);
+    if (layout.VertexCount == 0)
+    {
+        return;
+    }
+
+    // Activate the shader program, set the text color and move the layout to the requested position.
+    if (this->TextShader.Revision() != this->shaderRevision)
+        this->configureShader();
+    this->TextShader.Use();
+    this->TextShader.SetVector3f(this->colorLocation, color);
+    this->TextShader.SetVector2f(this->offsetLocation, glm::vec2(x, y));
+    RenderState::ActiveTexture(GL_TEXTURE0);
+    RenderState::BindTexture(GL_TEXTURE_2D, this->AtlasTexture);
+
+    // Render every character quad at once.
+    RenderState::BindVertexArray(layout.VAO);
+    glDrawArrays(GL_TRIANGLES, 0, layout.VertexCount);
 }
 
 // Renders text centered on the screen at the given vertical position.
@@ -182,16 +360,118 @@ void TextRenderer::RenderCenteredText(const std::string& text, float y, int widt
 }
 
 // Calculates the width of a text string based on the current font and scale.
+// The width is stored with the cached layout, so measuring and then rendering a string lays it out only once.
 float TextRenderer::GetTextWidth(const std::string& text, float scale) {
-    float width = 0.0f;
+    return this->layout(text, scale).Width;
+}
 
-    // Loop through each character and add its width to the total.
-    for (char c : text) {
-        if (Characters.find(c) != Characters.end()) {
-            Character ch = Characters[c];
-            width += (ch.Advance >> 6) * scale;  // Convert to pixels and apply scale.
+// Starts a new frame and releases the layouts of strings that are no longer being drawn
+// (for example old values of the lives counter or of a typed player name).
+void TextRenderer::NewFrame()
+{
+    ++this->frame;
+    for (auto iter = this->layouts.begin(); iter != this->layouts.end();)
+    {
+        if (this->frame - iter->second.LastUsedFrame > TEXT_LAYOUT_LIFETIME)
+        {
+            RenderState::DeleteVertexArray(iter->second.VAO);
+            RenderState::DeleteBuffer(iter->second.VBO);
+            iter = this->layouts.erase(iter);
+        }
+        else
+        {
+            ++iter;
         }
     }
+}
+
+// Returns the layout of a string at the given scale. On a cache miss the glyph quads are
+// positioned relative to the text origin and uploaded into a new vertex buffer.
+TextLayout& TextRenderer::layout(const std::string& text, float scale)
+{
+    auto iter = this->layouts.find(TextLayoutKeyRef{ text, scale, this->font });
+    if (iter != this->layouts.end())
+    {
+        iter->second.LastUsedFrame = this->frame;
+        return iter->second;
+    }
+
+    // Align every glyph to the top of the capital 'H' so that the origin is the top of the text line.
+    const Character* reference = this->glyph('H');
+    float top = reference != nullptr ? static_cast<float>(reference->Bearing.y) : 0.0f;
 
-    return width;
+    // Loop through each character in the text string.
+    float x = 0.0f;
+    this->vertices.clear();
+    for (char c : text)
+    {
+        // Skip characters that aren't available.
+        const Character* ch = this->glyph(c);
+        if (ch == nullptr)
+        {
+            continue;
+        }
+
+        // Calculate the position and size of the character quad.
+        float xpos = x + ch->Bearing.x * scale;
+        float ypos = (top - ch->Bearing.y) * scale;
+        float w = ch->Size.x * scale;
+        float h = ch->Size.y * scale;
+
+        // Define the vertices for the character quad.
+        float quad[6][4] = {
+            { xpos,     ypos + h,  ch->UVMin.x, ch->UVMax.y },
+            { xpos + w, ypos,      ch->UVMax.x, ch->UVMin.y },
+            { xpos,     ypos,      ch->UVMin.x, ch->UVMin.y },
+
+            { xpos,     ypos + h,  ch->UVMin.x, ch->UVMax.y },
+            { xpos + w, ypos + h,  ch->UVMax.x, ch->UVMax.y },
+            { xpos + w, ypos,      ch->UVMax.x, ch->UVMin.y }
+        };
+        this->vertices.insert(this->vertices.end(), &quad[0][0], &quad[0][0] + 6 * 4);
+
+        // Advance the cursor to the next character.
+        x += (ch->Advance >> 6) * scale; // Convert to pixels.
+    }
+
+    TextLayout layout;
+    layout.VertexCount = static_cast<unsigned int>(this->vertices.size() / 4);
+    layout.Width = x;
+    layout.LastUsedFrame = this->frame;
+
+    // Upload the quads into a static buffer owned by the layout.
+    if (layout.VertexCount > 0)
+    {
+        glGenVertexArrays(1, &layout.VAO);
+        glGenBuffers(1, &layout.VBO);
+        RenderState::BindVertexArray(layout.VAO);
+        RenderState::BindBuffer(GL_ARRAY_BUFFER, layout.VBO);
+        glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(float), this->vertices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    }
+
+    return this->layouts.emplace(TextLayoutKey{ text, scale, this->font }, layout).first->second;
+}
+
+// Deletes the GPU buffers of every cached layout and empties the cache.
+void TextRenderer::clearLayouts()
+{
+    for (auto& entry : this->layouts)
+    {
+        RenderState::DeleteVertexArray(entry.second.VAO);
+        RenderState::DeleteBuffer(entry.second.VBO);
+    }
+    this->layouts.clear();
+}
+
+// Looks up a character in the glyph table. Returns nullptr for codes outside the table or glyphs that failed to load.
+const Character* TextRenderer::glyph(char c) const
+{
+    unsigned char code = static_cast<unsigned char>(c);
+    if (code >= GLYPH_COUNT || !this->Characters[code].Loaded)
+    {
+        return nullptr;
+    }
+    return &this->Characters[code];
 }
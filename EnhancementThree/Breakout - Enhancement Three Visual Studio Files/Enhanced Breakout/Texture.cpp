@@ -10,23 +10,24 @@
 
 #include <iostream>
 #include "texture.h"
+#include "render_state.h"
 
 // Constructor that initializes default values for the texture object.
 Texture2D::Texture2D()
-    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
+    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR), Region(0.0f, 0.0f, 1.0f, 1.0f)
 {
     // Generate texture object in OpenGL
     glGenTextures(1, &this->ID);
 }
 
 // Generates a texture from image data and sets texture parameters.
-void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
+void Texture2D::Generate(unsigned int width, unsigned int height, const unsigned char* data)
 {
     this->Width = width;
     this->Height = height;
 
     // Bind the texture for subsequent configuration
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    RenderState::BindTexture(GL_TEXTURE_2D, this->ID);
 
     // Create the texture object in OpenGL and load the image data
     glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
@@ -38,15 +39,37 @@ void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char*
     // Set the texture filtering modes for minification and magnification
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
+}
+
+// Generates a texture from pre-built mip levels, so no mipmaps are computed at load time.
+void Texture2D::Generate(const std::vector<TextureLevel>& levels)
+{
+    if (levels.empty())
+        return;
+    this->Width = levels[0].Width;
+    this->Height = levels[0].Height;
+
+    RenderState::BindTexture(GL_TEXTURE_2D, this->ID);
+
+    // Level rows are tightly packed, which RGB levels narrower than 4 pixels rely on.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < levels.size(); ++level)
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), this->Internal_Format, levels[level].Width, levels[level].Height, 0, this->Image_Format, GL_UNSIGNED_BYTE, levels[level].Data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-    // Unbind the texture to prevent further modifications
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Only the levels present are sampled; a chain that stops early would otherwise be incomplete.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
 }
 
 // Binds the texture object to the current OpenGL context for use in rendering.
 void Texture2D::Bind() const
 {
-    // Bind the texture using its OpenGL ID
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    // Bind the texture using its OpenGL ID (skipped if it is already bound)
+    RenderState::BindTexture(GL_TEXTURE_2D, this->ID);
 }
 
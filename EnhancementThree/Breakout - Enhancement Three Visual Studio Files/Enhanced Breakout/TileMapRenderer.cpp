@@ -0,0 +1,157 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#include "tile_map_renderer.h"
+#include "render_state.h"
+
+#include <algorithm>
+
+#include <glm/gtc/type_ptr.hpp>
+
+// Texture units used by the tile map shader
+const unsigned int BLOCK_UNIT = 0;
+const unsigned int SOLID_BLOCK_UNIT = 1;
+const unsigned int TILE_UNIT = 2;
+
+
+// Deletes the tile texture.
+TileMap::~TileMap()
+{
+    RenderState::DeleteTexture(this->ID);
+}
+
+// Creates the integer tile texture from the given codes.
+void TileMap::Generate(unsigned int columns, unsigned int rows, const unsigned char* codes)
+{
+    this->Columns = columns;
+    this->Rows = rows;
+    if (this->ID == 0)
+    {
+        glGenTextures(1, &this->ID);
+    }
+
+    RenderState::BindTexture(GL_TEXTURE_2D, this->ID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Rows of single byte texels are not 4-byte aligned.
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, columns, rows, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, codes);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // Integer textures cannot be filtered; the shader reads them with texelFetch.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+// Updates one texel of the tile texture.
+void TileMap::SetTile(unsigned int column, unsigned int row, unsigned char code)
+{
+    RenderState::BindTexture(GL_TEXTURE_2D, this->ID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, column, row, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &code);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// Updates the whole tile texture in place.
+void TileMap::SetTiles(const unsigned char* codes)
+{
+    RenderState::BindTexture(GL_TEXTURE_2D, this->ID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->Columns, this->Rows, GL_RED_INTEGER, GL_UNSIGNED_BYTE, codes);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+
+// Constructor: stores the shader and textures and points the samplers at their units.
+TileMapRenderer::TileMapRenderer(Shader& shader, Texture2D& block, Texture2D& solidBlock)
+    : shader(shader), block(block), solidBlock(solidBlock), palette()
+{
+    this->configureShader();
+    this->initRenderData();
+}
+
+// Sets the sampler units, block regions and palette, and resolves the per-draw locations.
+void TileMapRenderer::configureShader()
+{
+    this->shader.SetInteger("block", BLOCK_UNIT, true);
+    this->shader.SetInteger("blockSolid", SOLID_BLOCK_UNIT);
+    this->shader.SetInteger("tiles", TILE_UNIT);
+    this->shader.SetVector4f("blockRegion", this->block.Region);
+    this->shader.SetVector4f("solidRegion", this->solidBlock.Region);
+    this->originLocation = this->shader.GetUniformLocation("origin");
+    this->sizeLocation = this->shader.GetUniformLocation("size");
+    this->paletteLocation = this->shader.GetUniformLocation("tileColors");
+    this->codeRangeLocation = this->shader.GetUniformLocation("codeRange");
+    glUniform3fv(this->paletteLocation, TILE_COLOR_COUNT, glm::value_ptr(this->palette[0]));
+    this->shaderRevision = this->shader.Revision();
+}
+
+// Destructor: deletes the quad's buffers.
+TileMapRenderer::~TileMapRenderer()
+{
+    RenderState::DeleteVertexArray(this->quadVAO);
+    RenderState::DeleteBuffer(this->quadVBO);
+}
+
+// Uploads the palette used to tint each tile code.
+void TileMapRenderer::SetPalette(const glm::vec3* colors)
+{
+    std::copy(colors, colors + TILE_COLOR_COUNT, this->palette);
+    this->shader.Use();
+    glUniform3fv(this->paletteLocation, TILE_COLOR_COUNT, glm::value_ptr(this->palette[0]));
+}
+
+// Draws the whole tile map with a single quad.
+void TileMapRenderer::Draw(const TileMap& tiles, glm::vec2 position, glm::vec2 size, unsigned int firstCode, unsigned int lastCode)
+{
+    if (!this->shader.IsReady())
+        return;
+    if (this->shader.Revision() != this->shaderRevision)
+        this->configureShader();
+    this->shader.Use();
+    this->shader.SetVector2f(this->originLocation, position);
+    this->shader.SetVector2f(this->sizeLocation, size);
+    glUniform2i(this->codeRangeLocation, firstCode, lastCode);
+
+    RenderState::ActiveTexture(GL_TEXTURE0 + BLOCK_UNIT);
+    this->block.Bind();
+    RenderState::ActiveTexture(GL_TEXTURE0 + SOLID_BLOCK_UNIT);
+    this->solidBlock.Bind();
+    RenderState::ActiveTexture(GL_TEXTURE0 + TILE_UNIT);
+    RenderState::BindTexture(GL_TEXTURE_2D, tiles.ID);
+    RenderState::ActiveTexture(GL_TEXTURE0);
+
+    RenderState::BindVertexArray(this->quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+// Creates the unit quad; texture coordinates match positions, so row 0 of the map is at the top.
+void TileMapRenderer::initRenderData()
+{
+    float vertices[] = {
+        // pos      // tex
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+
+    glGenVertexArrays(1, &this->quadVAO);
+    glGenBuffers(1, &this->quadVBO);
+
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    RenderState::BindVertexArray(this->quadVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+}
@@ -0,0 +1,81 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** AssetPack reads the single-file asset pack written by the
+** pack_assets tool.
+******************************************************************/
+
+
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+// Pack file layout (little endian):
+//   PackHeader
+//   PackEntry[EntryCount], sorted by name
+//   entry data, each blob aligned to PACK_ALIGNMENT and followed by a NUL byte
+//   that is not counted in its size, so text assets can be used as C strings.
+const char          PACK_MAGIC[4] = { 'B', 'K', 'P', 'K' };
+const uint32_t      PACK_VERSION = 1;
+const unsigned int  PACK_NAME_LENGTH = 56;   // Including the terminating NUL
+const unsigned int  PACK_ALIGNMENT = 16;
+
+struct PackHeader {
+    char     Magic[4];
+    uint32_t Version;
+    uint32_t EntryCount;
+    uint32_t Reserved;
+};
+
+struct PackEntry {
+    char     Name[PACK_NAME_LENGTH];  // Path relative to the asset root, e.g. "textures/block.png"
+    uint64_t Offset;                  // Start of the data from the beginning of the pack
+    uint64_t Size;                    // Size of the data in bytes, excluding the trailing NUL
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader must match the pack file layout");
+static_assert(sizeof(PackEntry) == 72, "PackEntry must match the pack file layout");
+
+// Bytes of one asset inside the mapped pack.
+struct AssetView {
+    const unsigned char* Data = nullptr;
+    size_t               Size = 0;
+};
+
+// AssetPack maps a pack file and looks up assets by name. Lookups only read
+// the mapping, so they are safe from any thread once Open has returned.
+class AssetPack
+{
+public:
+    // Maps and validates a pack. Returns false (and stays closed) if it is missing or malformed.
+    bool Open(const std::string& path);
+
+    // Unmaps the pack
+    void Close();
+
+    bool IsOpen() const { return this->file.IsOpen(); }
+
+    // Finds an asset by name; returns false if the pack does not contain it
+    bool Find(const std::string& name, AssetView& view) const;
+
+    // Appends the names of all assets starting with prefix, in sorted order
+    void List(const std::string& prefix, std::vector<std::string>& names) const;
+
+private:
+    MappedFile       file;
+    const PackEntry* entries = nullptr;
+    uint32_t         entryCount = 0;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** FileWatcher reports files that change in a set of directories.
+******************************************************************/
+
+
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// FileWatcher watches directories on a background thread and queues the files
+// written in them (inotify on Linux; elsewhere the modification times are polled
+// every few hundred milliseconds). The game drains the queue once per frame with
+// Poll, so all reloading happens on the thread that owns the GL context.
+class FileWatcher
+{
+public:
+    FileWatcher() { }
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Starts watching the directories, stopping any earlier watch. Subdirectories are not watched.
+    // Returns false if none of the directories could be watched.
+    bool Watch(const std::vector<std::string>& directories);
+
+    // Stops the background thread
+    void Stop();
+
+    // Returns the files written since the last call, each once, as "<directory>/<name>"
+    std::vector<std::string> Poll();
+
+private:
+    std::vector<std::string> directories;
+    std::thread              thread;
+    std::atomic<bool>        running{ false };
+    std::mutex               mutex;      // Guards changed
+    std::set<std::string>    changed;
+#ifdef __linux__
+    int                      inotify = -1;
+    std::map<int, std::string> watches;  // Watch descriptor to directory
+#else
+    std::map<std::string, unsigned long long> modified;  // Last write time of every file seen
+#endif
+
+    // Body of the background thread
+    void run();
+
+    // Queues a changed file
+    void record(const std::string& path);
+
+#ifndef __linux__
+    // Compares the files of every directory with the last scan, queueing the new and rewritten ones
+    void scan(bool report);
+#endif
+};
+
+#endif
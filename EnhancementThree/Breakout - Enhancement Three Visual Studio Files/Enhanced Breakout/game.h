@@ -19,8 +19,10 @@
 #include <GLFW/glfw3.h>
 
 #include <chrono>
+#include <vector>
 
 #include "game_level.h"
+#include "level_catalog.h"
 
 
 // --- Enumerations ---
@@ -35,6 +37,12 @@ enum GameState {
     HIGH_SCORE_DISPLAY   // Screen that displays the high scores for a level
 };
 
+// Ways of moving the ball and resolving its collisions
+enum CollisionMode {
+    COLLISION_DISCRETE,   // Move the whole step, then push the ball out of whatever it overlaps
+    COLLISION_CONTINUOUS  // Sweep the ball along its path and bounce off the first thing it touches
+};
+
 // Represents the four possible (collision) directions
 enum Direction {
     UP,
@@ -66,6 +74,15 @@ const glm::vec2 INITIAL_BALL_VELOCITY(0.0f, -500.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
 
+// Technique used to draw the bricks of the current level
+const LevelRenderMode LEVEL_RENDER_MODE = LEVEL_RENDER_INSTANCED;
+
+// Technique used to move the ball and find its collisions
+const CollisionMode COLLISION_MODE = COLLISION_CONTINUOUS;
+
+// Most contacts resolved for the ball in one update; motion left after the last one is dropped
+const unsigned int MAX_BALL_CONTACTS = 8;
+
 // --- Game Class ---
 
 // The `Game` class holds all game-related state and functionality.
@@ -77,14 +94,32 @@ private:
     float levelCompletionTime = 0;                                       // Time duration for level completion
     std::string playerName = "";                                          // String for capturing player name
 
+    // Draws the current level's bricks with the technique selected by LEVEL_RENDER_MODE
+    void drawBricks(BrickSet bricks);
+
+    // Returns the high score table of the current level, which follows its file number
+    int scoreTable() const;
+
+    // Scratch list of the bricks near the ball, filled by DoCollisions each frame
+    std::vector<size_t> nearbyBricks;
+
+    // Paddle and ball positions before the last simulation step, used to interpolate rendering
+    glm::vec2 previousPlayerPosition = glm::vec2(0.0f);
+    glm::vec2 previousBallPosition = glm::vec2(0.0f);
+
+    // Moves the ball through the step in continuous mode, bouncing off walls, bricks and the
+    // paddle in the order it reaches them
+    void sweepBall(float dt);
+
 public:
     // --- Game State ---
     GameState               State;                // Current state of the game.
     bool                    Keys[1024];           // Stores the state of each key (pressed/released).
     bool                    KeysProcessed[1024];  // Keeps track of key presses that have been processed
     unsigned int            Width, Height;        // Dimensions of the game window.
-    std::vector<GameLevel>  Levels;               // Stores all game levels.
-    unsigned int            Level;                // Current game level index.
+    unsigned int            FramebufferWidth, FramebufferHeight;  // Current size of the default framebuffer in pixels.
+    LevelCatalog            Levels;               // Every level found in the levels directory, loaded on demand.
+    unsigned int            Level;                // Current game level index into Levels.
     unsigned int            Lives;                // Keeps track of the player's lives
 
 
@@ -97,6 +132,9 @@ public:
     // Initializes game state, including loading shaders, textures, and levels.
     void Init();
 
+    // Records a new framebuffer size; cached frame layers are rebuilt at the new size.
+    void Resize(unsigned int width, unsigned int height);
+
     // Process input for inputting a username
     void ProcessCharInput(char c);
 
@@ -106,8 +144,16 @@ public:
     // Updates the game state based on the time elapsed between frames (delta time).
     void Update(float dt);
 
-    // Renders the current game frame.
-    void Render();
+    // Advances the simulation by one fixed step: processes input, then updates the game state.
+    void Step(float dt);
+
+    // Renders the current game frame. alpha is how far the frame lies between the last two
+    // simulation steps (0 to 1); the paddle and ball are drawn blended between them.
+    void Render(float alpha = 1.0f);
+
+    // Reloads the shaders, textures and levels whose files changed since the last call.
+    // Called once per frame, before the frame is updated and drawn.
+    void HotReload();
 
     // Handles all collisions between game objects.
     void DoCollisions();
@@ -118,7 +164,7 @@ public:
     void ResetLevel();
 
     // Resets the player's position and state to its initial configuration.
-    void ResetPlayer() const;
+    void ResetPlayer();
 
     // Begins timer for recording level completion time
     void StartLevelTimer();
@@ -8,23 +8,63 @@
 ******************************************************************/
 #ifndef GAMELEVEL_H
 #define GAMELEVEL_H
+#include <cstdint>
 #include <vector>
+#include <memory>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "game_object.h"
 #include "sprite_renderer.h"
+#include "tile_map_renderer.h"
 #include "resource_manager.h"
 
 
+// Tile codes of a level: Columns * Rows codes, row by row from the top
+struct TileData {
+    std::vector<unsigned char> Tiles;
+    unsigned int               Columns = 0, Rows = 0;
+};
+
+// Techniques available for drawing a level's bricks
+enum LevelRenderMode {
+    LEVEL_RENDER_INSTANCED,  // One sprite instance per brick, kept in a persistent buffer
+    LEVEL_RENDER_TILE_MAP    // The tile grid as an integer texture, drawn as a single quad
+};
+
+// Subsets of a level's bricks that can be drawn separately
+enum BrickSet {
+    BRICKS_ALL,
+    BRICKS_BREAKABLE,
+    BRICKS_SOLID
+};
+
+// GPU copy of a level's bricks: one sprite instance per brick, with the
+// breakable bricks stored first and the solid bricks after them.
+struct BrickBuffer {
+    unsigned int VBO = 0;           // Instance buffer holding every brick
+    unsigned int BreakableVAO = 0;  // Vertex array reading the breakable bricks
+    unsigned int SolidVAO = 0;      // Vertex array reading the solid bricks
+
+    // Deletes the buffer and vertex arrays
+    ~BrickBuffer();
+};
+
 // GameLevel represents a Breakout game level and handles loading,
 // rendering, and checking level completion based on tile destruction.
 class GameLevel
 {
 public:
-    // Public member to hold all bricks for the level.
-    std::vector<GameObject> Bricks;
+    // Bricks of the level as parallel arrays indexed by brick, so collision tests read only
+    // what they need. Breakable bricks come first, matching their slots in the brick buffer.
+    // Every brick fills one grid cell, so all bricks share one size.
+    std::vector<glm::vec2>     BrickPositions;  // Top-left corner of each brick
+    std::vector<unsigned char> BrickCodes;      // Tile code of each brick: 1 is solid, higher codes pick the color
+    glm::vec2                  BrickSize = glm::vec2(0.0f);
+
+    // Changes every time the level is loaded; used to tell whether cached renderings are stale
+    unsigned int Generation = 0;
 
     // Default constructor
     GameLevel() { }
@@ -32,15 +72,98 @@ public:
     // Loads level from a file and initializes tile data.
     void Load(std::string file, unsigned int levelWidth, unsigned int levelHeight);
 
-    // Renders the current level's tiles (bricks)
-    void Draw(SpriteRenderer& renderer);
+    // Reads a level file into tile codes. Touches no shared state, so it can run on a worker thread.
+    // A compiled .blvl file next to the level file (see tools/compile_level) is used when present,
+    // unless the level file was written after it.
+    static TileData Parse(const std::string& file);
+
+    // Initializes the level from parsed tile data. Must run on the main thread, since it
+    // looks up the brick textures in the ResourceManager.
+    void Load(const TileData& tileData, unsigned int levelWidth, unsigned int levelHeight);
+
+    // Renders the current level's tiles (bricks) from the persistent brick buffer
+    void Draw(SpriteRenderer& renderer, BrickSet bricks = BRICKS_ALL);
+
+    // Renders the current level's tiles (bricks) from the level's tile map
+    void Draw(TileMapRenderer& renderer, BrickSet bricks = BRICKS_ALL);
+
+    // Returns the number of bricks, destroyed ones included
+    size_t BrickCount() const { return this->BrickPositions.size(); }
+
+    // Returns whether the level has any breakable bricks, i.e. can be played and completed
+    bool IsPlayable() const { return this->breakableCount > 0; }
+
+    // Returns whether a brick is solid (solid bricks follow the breakable ones)
+    bool IsSolid(size_t index) const { return index >= this->breakableCount; }
+
+    // Returns whether a brick has been destroyed
+    bool IsDestroyed(size_t index) const { return (this->destroyed[index / 64] >> (index % 64)) & 1; }
 
-    // Checks if the level is completed (all non-solid tiles are destroyed)
-    bool IsCompleted();
+    // Builds a GameObject describing a brick, for code that works with whole game objects
+    GameObject Brick(size_t index) const;
+
+    // Marks a brick as destroyed and hides it in the brick buffer and tile map
+    void DestroyBrick(size_t index);
+
+    // Finds the bricks in the grid cells a rectangle overlaps, so collision tests only visit
+    // the few bricks near an object. Destroyed bricks are included.
+    // Parameters:
+    //   - min, max: Corners of the rectangle
+    //   - bricks: Receives the brick indices, in ascending order
+    void QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<size_t>& bricks) const;
+
+    // Restores every brick to its state right after Load. Neither reads files nor allocates.
+    void Reset();
+
+    // Returns the color of the given tile code (white for unknown codes)
+    static glm::vec3 TileColor(unsigned int code);
+
+    // Checks if the level is completed (all non-solid tiles are destroyed; never for a level without any)
+    bool IsCompleted() const;
 
 private:
+    // Brick buffer, built on the first draw after Load; levels own their GL objects and are move-only
+    std::unique_ptr<BrickBuffer> buffer;
+
+    // Tile map, built on the first tile map draw after Load
+    std::unique_ptr<TileMap> tileMap;
+
+    // Number of breakable bricks at the front of the brick arrays, and how many of them are destroyed
+    size_t breakableCount = 0;
+    size_t destroyedCount = 0;
+
+    // One bit per brick, set once the brick is destroyed
+    std::vector<uint64_t> destroyed;
+
+    // Brick textures, looked up in the ResourceManager when the level is loaded
+    Texture2D* blockSprite = nullptr;
+    Texture2D* solidSprite = nullptr;
+
+    // Tile grid (row-major codes), its state as loaded, the area it covers, and the grid cell of each brick
+    std::vector<unsigned char> tiles;
+    std::vector<unsigned char> pristineTiles;
+    unsigned int columns = 0, rows = 0;
+    glm::vec2 area = glm::vec2(0.0f);
+    std::vector<unsigned int> brickCells;
+
+    // Size of one grid cell, and the brick in each cell (NO_BRICK for empty cells)
+    glm::vec2 cellSize = glm::vec2(0.0f);
+    std::vector<unsigned int> cellBricks;
+
+    // Splits level text into rows of tile codes; levels with rows of different lengths are rejected
+    static TileData parseTiles(const char* text, size_t size);
+
+    // Reads the tile codes of a compiled level, validating its size and checksum
+    static bool readCompiled(const unsigned char* data, size_t size, TileData& tileData);
+
+    // Brick buffer contents with every brick intact, kept so Reset can restore the buffer in one upload
+    std::vector<SpriteInstance> pristineInstances;
+
+    // Uploads every brick into a new brick buffer
+    void buildBuffer(SpriteRenderer& renderer);
+
     // Private helper function to initialize level from tile data
-    void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
+    void init(const TileData& tileData, unsigned int levelWidth, unsigned int levelHeight);
 };
 
 #endif
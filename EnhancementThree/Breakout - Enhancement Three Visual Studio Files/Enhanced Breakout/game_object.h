@@ -50,6 +50,7 @@ public:
     GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
 
     // Draw the sprite on the screen using the provided renderer
+    // (recorded into the renderer's sprite batch if one is open)
     // Parameters:
     // - renderer: The SpriteRenderer object used to draw the sprite.
     virtual void Draw(SpriteRenderer& renderer);
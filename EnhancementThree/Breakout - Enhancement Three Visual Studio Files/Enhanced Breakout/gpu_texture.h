@@ -0,0 +1,46 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** Layout of the pre-decoded texture files (.gtex) written by the
+** make_gtex tool and read by ResourceManager.
+******************************************************************/
+
+
+#ifndef GPU_TEXTURE_H
+#define GPU_TEXTURE_H
+
+#include <cstdint>
+
+// Texture file layout (little endian):
+//   GpuTextureHeader
+//   GpuTextureLevel[LevelCount], largest level first
+//   level pixels, 8-bit channels, rows tightly packed (no row alignment)
+// A .gtex file sits next to the image it was converted from, with the same base name.
+const char         GPU_TEXTURE_MAGIC[4] = { 'G', 'T', 'E', 'X' };
+const uint32_t     GPU_TEXTURE_VERSION = 1;
+const char* const  GPU_TEXTURE_EXTENSION = ".gtex";
+const unsigned int GPU_TEXTURE_MAX_LEVELS = 16;
+
+struct GpuTextureHeader {
+    char     Magic[4];
+    uint32_t Version;
+    uint32_t Channels;    // 3 (RGB) or 4 (RGBA)
+    uint32_t LevelCount;  // Mip levels stored, down to 1x1 unless the converter stopped earlier
+};
+
+struct GpuTextureLevel {
+    uint32_t Width;
+    uint32_t Height;
+    uint64_t Offset;      // Start of the pixels from the beginning of the file
+    uint64_t Size;        // Width * Height * Channels
+};
+
+static_assert(sizeof(GpuTextureHeader) == 16, "GpuTextureHeader must match the texture file layout");
+static_assert(sizeof(GpuTextureLevel) == 24, "GpuTextureLevel must match the texture file layout");
+
+#endif
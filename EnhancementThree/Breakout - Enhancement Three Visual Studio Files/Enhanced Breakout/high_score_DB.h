@@ -26,6 +26,7 @@
 #define HIGHSCOREDB_H
 
 #include <sqlite3.h>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -45,6 +46,7 @@ public:
     ~HighScoreDB();
 
     // Creates a high score table for a specific level if it does not already exist.
+    // The other functions call this themselves, so tables only exist for levels that were used.
     bool createTable(int level);
 
     // Adds a new high score entry to the specified level's table.
@@ -58,6 +60,7 @@ public:
 
 private:
     sqlite3* db;  // Pointer to the SQLite database connection.
+    std::set<int> createdTables;  // Levels whose table is known to exist.
 
     // Executes a given SQL query that does not return results (e.g., CREATE, DELETE).
     bool executeQuery(const std::string& query);
@@ -0,0 +1,76 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+
+#ifndef LEVEL_CATALOG_H
+#define LEVEL_CATALOG_H
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "game_level.h"
+
+// LevelCatalog lists the levels found in a directory and loads them on demand.
+// Levels are files named by their number ("1.lvl", "2.lvl", ... or compiled
+// ".blvl"), played in numeric order. Only the selected level and its two
+// neighbours are kept; the neighbours are parsed on a background thread when a
+// level is selected, so memory and startup time do not grow with the catalog.
+class LevelCatalog
+{
+public:
+    // Lists the levels of a directory, from the asset pack if it has any, otherwise from the file system.
+    // Parameters:
+    //   - directory: Directory holding the level files, e.g. "../levels"
+    //   - levelWidth, levelHeight: Area the bricks of every level are laid out in
+    void Scan(const std::string& directory, unsigned int levelWidth, unsigned int levelHeight);
+
+    // Returns the number of levels found
+    size_t Size() const { return this->entries.size(); }
+
+    // Returns the number in the file name of a level (1 for "1.lvl")
+    unsigned int Number(size_t index) const { return this->entries[index].Number; }
+
+    // Returns a level, loading it first if needed. Indices past the end give an empty level.
+    GameLevel& operator[](size_t index);
+
+    // Makes a level the selected one: its neighbours are prefetched and every other level is released.
+    void Select(size_t index);
+
+    // Returns the index of the selected level
+    size_t Selected() const { return this->selected; }
+
+    // Reloads a level whose file has changed if it is loaded or being prefetched, and lists
+    // levels that did not exist yet. The reloaded level gets a new Generation. Listing a new
+    // level before the selected one moves the selection, so callers re-read Selected().
+    // Parameters:
+    //   - file: Path of the changed file, e.g. "../levels/3.lvl" or "../levels/3.blvl"
+    // Returns: Whether the file is a level of this catalog
+    bool FileChanged(const std::string& file);
+
+private:
+    struct Entry {
+        std::string                File;      // Path of the text level file (".lvl")
+        unsigned int               Number = 0;
+        std::unique_ptr<GameLevel> Level;     // Loaded level, if any
+        std::future<TileData>      Parsed;    // Background parse started by Select, if any
+    };
+
+    std::vector<Entry> entries;
+    std::string        directory;             // Directory passed to Scan
+    size_t             selected = 0;          // Index passed to the last Select
+    unsigned int       levelWidth = 0, levelHeight = 0;
+    GameLevel          empty;                 // Returned for invalid indices
+
+    // Starts parsing a level on a background thread unless it is loaded or being parsed already
+    void prefetch(size_t index);
+};
+
+#endif
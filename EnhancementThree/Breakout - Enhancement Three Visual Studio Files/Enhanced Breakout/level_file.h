@@ -0,0 +1,49 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** Layout of the compiled level files (.blvl) written by the
+** compile_level tool and read by GameLevel::Parse.
+******************************************************************/
+
+
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Level file layout (little endian):
+//   LevelFileHeader
+//   Columns * Rows tile codes, one byte each, row by row from the top
+// A .blvl file sits next to the .lvl file it was compiled from, with the same base name.
+const char         LEVEL_FILE_MAGIC[4] = { 'B', 'K', 'L', 'V' };
+const uint32_t     LEVEL_FILE_VERSION = 1;
+const char* const  LEVEL_FILE_EXTENSION = ".blvl";
+const uint32_t     LEVEL_MAX_DIMENSION = 1024;   // Largest number of rows or columns accepted
+
+struct LevelFileHeader {
+    char     Magic[4];
+    uint32_t Version;
+    uint32_t Columns;
+    uint32_t Rows;
+    uint32_t Checksum;   // LevelChecksum of the tile codes
+    uint32_t Reserved;
+};
+
+static_assert(sizeof(LevelFileHeader) == 24, "LevelFileHeader must match the level file layout");
+
+// 32-bit FNV-1a over the tile codes
+inline uint32_t LevelChecksum(const unsigned char* tiles, size_t count)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count; ++i)
+        hash = (hash ^ tiles[i]) * 16777619u;
+    return hash;
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** MappedFile maps a whole file read-only into memory.
+******************************************************************/
+
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// MappedFile maps a file read-only into the address space (MapViewOfFile on
+// Windows, mmap elsewhere). The mapping stays valid until Close is called or
+// the object is destroyed, so it cannot be copied.
+class MappedFile
+{
+public:
+    MappedFile() { }
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file, closing any previous mapping. Returns false if the file cannot be mapped.
+    bool Open(const std::string& path);
+
+    // Unmaps the file
+    void Close();
+
+    // Returns whether a file is mapped
+    bool IsOpen() const { return this->data != nullptr; }
+
+    // Start and size of the mapped bytes
+    const unsigned char* Data() const { return this->data; }
+    size_t               Size() const { return this->size; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t               size = 0;
+#ifdef _WIN32
+    void*                file = nullptr;     // HANDLE of the open file
+    void*                mapping = nullptr;  // HANDLE of the file mapping
+#endif
+};
+
+#endif
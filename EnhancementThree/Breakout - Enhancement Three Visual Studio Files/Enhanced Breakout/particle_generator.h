@@ -31,6 +31,12 @@ struct Particle {
 	Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
 };
 
+// Per-instance data streamed to the GPU for each live particle.
+struct ParticleInstance {
+	glm::vec2 Offset;
+	glm::vec4 Color;
+};
+
 // ParticleGenerator allows a large number of particles to be spawned,
 // updated, and rendered. It uses a Shader for rendering and a Texture2D
 // to define the appearance of particles. 
@@ -43,7 +49,8 @@ public:
 	// Update all particles.
 	void Update(float dt, GameObject& object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
 
-	// Render all particles.
+	// Render all live particles with a single instanced draw call.
+	// The caller sets up additive blending (the game submits particles in RENDER_PASS_ADDITIVE).
 	void Draw();
 
 private:
@@ -55,10 +62,17 @@ private:
 	Shader shader;
 	Texture2D texture;
 	unsigned int VAO;
+	unsigned int instanceVBO;                 // Per-instance offset and color of the live particles
+	std::vector<ParticleInstance> instances;  // Scratch buffer filled with the live particles each frame
+
+	unsigned int shaderRevision = 0;          // Link revision of the shader the region was set for
 
 	// Initializes the buffer and vertex attributes required for rendering particles.
 	void init();
 
+	// Sets the uniforms that stay the same for every draw (again after the shader is reloaded).
+	void configureShader();
+
 	// Returns the first particle index that's currently unused (Life <= 0) or 0 if there are no currently active particles.
 	unsigned int firstUnusedParticle();
 
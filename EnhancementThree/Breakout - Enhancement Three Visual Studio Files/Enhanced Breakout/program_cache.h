@@ -0,0 +1,61 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** ProgramCache stores linked shader program binaries on disk so
+** later launches can skip GLSL compilation.
+******************************************************************/
+
+
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include <glad/glad.h>
+
+// The ProgramCache class keeps linked program binaries (glGetProgramBinary)
+// in a directory, one file per program, keyed by a hash of the shader sources
+// and the GL vendor, renderer and version strings. Program binaries are not
+// part of OpenGL 3.3, so the entry points are loaded at run time; when the
+// driver supports neither GL 4.1 nor ARB_get_program_binary the cache stays
+// disabled and every program is compiled from source.
+class ProgramCache
+{
+public:
+    // Loads the program binary entry points and selects the cache directory.
+    // Must be called after the GL context is current.
+    static void Init(const std::string& directory);
+
+    // Returns whether program binaries are available
+    static bool IsEnabled();
+
+    // Returns the cache key of a program built from the given sources (geometry may be nullptr)
+    static uint64_t Key(const char* vertexSource, const char* fragmentSource, const char* geometrySource);
+
+    // Marks a program, before linking, so that its binary can be retrieved
+    static void MarkRetrievable(unsigned int program);
+
+    // Loads the cached binary for key into program. Returns whether it was found and linked.
+    static bool Load(unsigned int program, uint64_t key);
+
+    // Writes the binary of a linked program to the cache
+    static void Store(unsigned int program, uint64_t key);
+
+    // Prints the number of cache hits and misses so far
+    static void Report();
+
+private:
+    // Private constructor to prevent instantiation of the ProgramCache class
+    ProgramCache() { }
+
+    // Returns the cache file of a key
+    static std::string path(uint64_t key);
+};
+
+#endif
@@ -0,0 +1,58 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** RenderQueue collects the draw commands of a frame and executes
+** them sorted by pass, shader, texture and depth.
+******************************************************************/
+
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Passes, executed in this order. Opaque commands are drawn with blending
+// disabled; the two blended passes are interleaved by depth.
+enum RenderPass {
+    RENDER_PASS_OPAQUE,    // No blending; commands in this pass must not overlap each other
+    RENDER_PASS_ALPHA,     // Regular alpha blending
+    RENDER_PASS_ADDITIVE   // Additive blending (glow effects)
+};
+
+// A queued draw: the sort key, the pass it belongs to and the code that issues the draw.
+struct RenderCommand {
+    uint64_t              Key;
+    RenderPass            Pass;
+    std::function<void()> Draw;
+};
+
+// RenderQueue sorts a frame's commands by a 64-bit key so that opaque geometry
+// comes first, grouped by shader and texture, followed by the blended commands
+// in depth order (lowest depth first), grouped by blend mode, shader and
+// texture within each depth. Commands with equal keys keep submission order.
+class RenderQueue
+{
+public:
+    // Queues a draw. program and texture are the GL names the draw will bind (0 if none);
+    // they are only used for sorting. depth orders blended commands back to front.
+    void Submit(RenderPass pass, unsigned int depth, unsigned int program, unsigned int texture, std::function<void()> draw);
+
+    // Sorts and executes the queued commands, then restores the default blend state
+    // (blending enabled, source alpha / one minus source alpha) and empties the queue.
+    void Execute();
+
+    // Builds the sort key of a command
+    static uint64_t MakeKey(RenderPass pass, unsigned int depth, unsigned int program, unsigned int texture);
+
+private:
+    std::vector<RenderCommand> commands;
+};
+
+#endif
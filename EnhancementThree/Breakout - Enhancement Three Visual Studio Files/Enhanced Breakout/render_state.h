@@ -0,0 +1,80 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** RenderState caches the OpenGL binding state shared by the
+** renderers and skips calls that would not change it.
+******************************************************************/
+
+
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+#include <glad/glad.h>
+
+// Number of texture units tracked by the cache
+const unsigned int RENDER_STATE_TEXTURE_UNITS = 8;
+
+// Counters of state changes requested through RenderState.
+struct RenderStateStats {
+    unsigned long Issued = 0;  // Calls that changed state and were passed on to OpenGL
+    unsigned long Elided = 0;  // Calls skipped because the requested state was already set
+};
+
+// The RenderState class is a static cache of the current program, texture
+// unit, texture, vertex array, array buffer and blend state. Every renderer
+// changes this state through RenderState so redundant GL calls are skipped.
+// Objects must be deleted through the Delete* functions so the cache never
+// holds a name that OpenGL may hand out again.
+class RenderState
+{
+public:
+    // Makes the program current.
+    static void UseProgram(unsigned int program);
+
+    // Selects the active texture unit (GL_TEXTURE0 + n).
+    static void ActiveTexture(unsigned int unit);
+
+    // Binds a texture to the given target (GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY) of the active unit.
+    static void BindTexture(unsigned int target, unsigned int texture);
+
+    // Binds a vertex array object.
+    static void BindVertexArray(unsigned int vao);
+
+    // Binds a buffer. Only GL_ARRAY_BUFFER is cached; other targets are passed straight through.
+    static void BindBuffer(unsigned int target, unsigned int buffer);
+
+    // Enables or disables blending.
+    static void SetBlend(bool enabled);
+
+    // Sets the blend function.
+    static void BlendFunc(unsigned int source, unsigned int destination);
+
+    // Deletes GL objects and removes them from the cache.
+    static void DeleteProgram(unsigned int program);
+    static void DeleteTexture(unsigned int texture);
+    static void DeleteVertexArray(unsigned int vao);
+    static void DeleteBuffer(unsigned int buffer);
+
+    // Forgets all cached state, e.g. after code outside the renderers changed GL state directly.
+    static void Invalidate();
+
+    // Returns the counters accumulated since the last ResetStats call.
+    static const RenderStateStats& Stats();
+
+    // Clears the counters.
+    static void ResetStats();
+
+private:
+    // Private constructor to prevent instantiation of the RenderState class
+    RenderState() { }
+
+    // Returns the cache slot for a texture target (0 for GL_TEXTURE_2D, 1 for GL_TEXTURE_2D_ARRAY, -1 if not cached).
+    static int targetSlot(unsigned int target);
+};
+
+#endif
@@ -12,13 +12,28 @@
 #define RESOURCE_MANAGER_H
 
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
 #include "texture.h"
 #include "shader.h"
-
+#include "asset_pack.h"
+#include "mapped_file.h"
+
+
+// Pixels decoded from an image file but not yet uploaded to the GPU.
+// The data is freed by the LoadTexture or LoadAtlas call that uploads it.
+struct DecodedImage {
+    std::string    File;
+    const unsigned char* Data = nullptr;  // Pixels of the largest level (nullptr if decoding failed)
+    int            Width = 0, Height = 0;
+    double         DecodeMilliseconds = 0.0;  // Time spent reading and decoding the file
+    std::vector<TextureLevel> Levels;   // Mip chain of a pre-decoded .gtex file; empty when decoded by stb_image
+    std::shared_ptr<MappedFile> Storage;  // Mapping of the loose .gtex file the levels point into (null for packed files)
+};
 
 // The ResourceManager class is a singleton that manages the loading and retrieval
 // of resources such as shaders and textures. It provides static functions to 
@@ -40,6 +55,17 @@ public:
     // Returns: The generated Shader object
     static Shader    LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name);
 
+    // Like LoadShader, but returns without waiting for the driver to compile and link the program.
+    // The stored shader reports IsReady() once it has linked; FinishShaders() waits for all of them.
+    // Parameters:
+    //   - vShaderFile, fShaderFile, gShaderFile: Shader source files (gShaderFile may be nullptr)
+    //   - name: A string name to reference the shader in the resource map
+    static void      SubmitShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name);
+
+    // Waits for every submitted shader, finishing them in the order the driver completes them,
+    // and stores their binaries in the program cache.
+    static void      FinishShaders();
+
     // Retrieves a stored shader by its name.
     // Parameters:
     //   - name: The name of the shader to retrieve
@@ -54,16 +80,77 @@ public:
     // Returns: The generated Texture2D object
     static Texture2D LoadTexture(const char* file, bool alpha, std::string name);
 
+    // Uploads an image decoded by DecodeImage and stores it like LoadTexture, reporting the
+    // decode and upload times. Must be called on the thread that owns the GL context.
+    static Texture2D LoadTexture(DecodedImage image, bool alpha, std::string name);
+
+    // Reads and decodes an image file without touching OpenGL or the resource maps,
+    // so it can run on a worker thread. A pre-decoded .gtex file next to the image
+    // (written by tools/make_gtex) is used instead when its channel count matches.
+    // Parameters:
+    //   - file: Path to the texture image file
+    //   - channels: Number of channels to convert the image to (0 keeps the file's channels)
+    static DecodedImage DecodeImage(const std::string& file, int channels = 0);
+
+    // Loads several images and packs them into a single atlas texture stored under name.
+    // Each image is also stored under its own name, sharing the atlas texture and
+    // carrying its UV region, so sprites drawn from the same atlas need no texture switch.
+    // Parameters:
+    //   - images: Pairs of image file path and texture name
+    //   - name: A string name to reference the atlas itself
+    // Returns: The atlas Texture2D object
+    static Texture2D LoadAtlas(const std::vector<std::pair<std::string, std::string>>& images, std::string name);
+
+    // Packs images decoded by DecodeImage (with 4 channels) into an atlas, as above.
+    static Texture2D LoadAtlas(const std::vector<std::pair<DecodedImage, std::string>>& images, std::string name);
+
     // Retrieves a stored texture by its name.
     // Parameters:
     //   - name: The name of the texture to retrieve
     // Returns: A reference to the Texture2D object
     static Texture2D& GetTexture(std::string name);
 
+    // Maps an asset pack. While it is open, every loader looks up its file in the pack first
+    // and only falls back to the file system for assets the pack does not contain.
+    // Parameters:
+    //   - path: Path to the pack file
+    // Returns: Whether the pack was opened
+    static bool      OpenPack(const std::string& path);
+
+    // Finds a file in the open asset pack. Paths are matched the way the game spells them
+    // (e.g. "../textures/block.png"), ignoring leading "../" and "./" and letter case.
+    // Safe to call from worker threads.
+    // Returns: Whether the pack is open and contains the file
+    static bool      FindAsset(const std::string& path, AssetView& view);
+
+    // Lists the assets of the open asset pack that lie in a directory (and its subdirectories).
+    // Parameters:
+    //   - directory: Directory as the game spells it, e.g. "../levels"
+    // Returns: The pack names of the assets, e.g. "levels/1.lvl", sorted
+    static std::vector<std::string> ListAssets(const std::string& directory);
+
+    // Converts a game asset path into the name it has in an asset pack
+    static std::string PackName(const std::string& path);
+
+    // Returns whether an asset pack is open
+    static bool      IsPackOpen();
+
+    // Reloads whatever was loaded from a changed file, keeping every GL ID: shaders using it are
+    // recompiled and relinked, textures re-uploaded, and atlas images copied into their region
+    // (an atlas image that changed size needs a restart to be repacked). A changed .gtex file
+    // reloads the image it was converted from. Must be called on the thread that owns the GL context.
+    // Parameters:
+    //   - file: Path of the changed file, spelled like the paths the assets were loaded with
+    // Returns: Whether anything was reloaded
+    static bool      Reload(const std::string& file);
+
     // Properly de-allocates all loaded resources, clearing the resource maps.
     static void      Clear();
 
 private:
+    // Asset pack used by the loaders, if one has been opened
+    static AssetPack Pack;
+
     // Private constructor to prevent instantiation of the ResourceManager class
     ResourceManager() { }
     // Loads and generates a shader from the specified files.
@@ -72,14 +159,46 @@ private:
     //   - fShaderFile: Path to the fragment shader file
     //   - gShaderFile: Path to the optional geometry shader file (default: nullptr)
     // Returns: The generated Shader object
-    static Shader    loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr);
+    static Shader    loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr, bool wait = true);
 
-    // Loads a single texture from the specified file.
+    // Creates a program from the binary cache, or compiles it from source and caches the result.
     // Parameters:
-    //   - file: Path to the texture image file
+    //   - label: Name reported in the load log
+    //   - vertexSource, fragmentSource, geometrySource: Shader sources (geometry may be nullptr)
+    //   - wait: Whether to wait for compilation; otherwise the program is left to FinishShaders()
+    // Returns: The generated Shader object
+    static Shader    buildProgram(const char* label, const char* vertexSource, const char* fragmentSource, const char* geometrySource, bool wait);
+
+    // Generates a single texture from a decoded image and frees the image data.
+    // Parameters:
+    //   - image: The decoded image
     //   - alpha: Whether the texture has an alpha channel (transparency)
     // Returns: The generated Texture2D object
-    static Texture2D loadTextureFromFile(const char* file, bool alpha);
+    static Texture2D loadTextureFromImage(const DecodedImage& image, bool alpha);
+
+    // Reads the .gtex file converted from an image file, if there is one.
+    // Parameters:
+    //   - file: Path to the original image file
+    //   - channels: Channels the caller needs (0 accepts any)
+    //   - image: Receives the levels of the texture
+    // Returns: Whether a usable .gtex file was read
+    static bool      readGpuTexture(const std::string& file, int channels, DecodedImage& image);
+
+    // Frees the pixels of a decoded image once they have been uploaded
+    static void      releaseImage(const DecodedImage& image);
+
+    // Copies an RGBA image into a larger pixel buffer, extending its edge pixels SPRITE_PADDING pixels outwards.
+    // Parameters:
+    //   - image: The decoded image
+    //   - target: Pixel that receives the top-left corner of the padding
+    //   - targetWidth: Width of the target buffer in pixels
+    static void      copyPadded(const DecodedImage& image, unsigned char* target, int targetWidth);
+
+    // Recompiles the shaders built from a changed source file (see Reload)
+    static bool      reloadShaders(const std::string& file);
+
+    // Re-uploads the textures decoded from a changed image file (see Reload)
+    static bool      reloadTextures(const std::string& file);
 };
 
 #endif
@@ -11,12 +11,31 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// Binding point of the uniform block shared by every program ("Frame")
+const unsigned int FRAME_UNIFORM_BINDING = 0;
+
+// Active uniforms of a linked program: name and location pairs
+typedef std::vector<std::pair<std::string, int>> UniformTable;
+
+// Link state of a program. Stages holds the shader objects of a submitted program
+// whose compile and link results have not been checked yet.
+struct ProgramState {
+    unsigned int Stages[3];
+    unsigned int StageCount = 0;
+    bool         Linked = false;
+    unsigned int Revision = 0;   // Incremented each time the program is (re)linked
+};
+
 // General purpose shader object. Compiles from file, generates
 // compile/link-time error messages and hosts several utility 
 // functions for easy management.
@@ -31,6 +50,27 @@ public:
     Shader  &Use();
     // compiles the shader from given source code
     void    Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr); // note: geometry source code is optional 
+    // starts compiling and linking without waiting for the driver; the program may only be used once IsReady() returns true
+    void    Submit(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr);
+    // returns whether the program has linked, finishing it if the driver is done (never blocks with parallel compilation)
+    bool    IsReady();
+    // waits for a submitted program to link and reports any compile or link errors
+    void    Finish();
+    // enables KHR/ARB_parallel_shader_compile when the driver offers it; returns whether it did
+    static bool InitParallelCompile();
+    // creates the program from the binary cached under key (see ProgramCache); returns false and leaves ID at 0 on a miss
+    bool    LoadBinary(uint64_t key);
+    // recompiles the program from new sources, keeping its ID; on any error the old program stays in place
+    bool    Reload(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr);
+    // returns how often the program has linked; uniform values are lost on relinking, so
+    // users that set them once compare this against the revision they configured
+    unsigned int Revision() const { return this->state ? this->state->Revision : 0; }
+    // returns the location of an active uniform, resolved once at link time (-1 if the uniform is not active)
+    int     GetUniformLocation(const char *name) const;
+    // uploads the per-frame values shared by every program through the "Frame" uniform block
+    static void UpdateFrameUniforms(const glm::mat4 &projection);
+    // deletes the shared per-frame uniform buffer
+    static void ReleaseFrameUniforms();
     // utility functions
     void    SetFloat    (const char *name, float value, bool useShader = false);
     void    SetInteger  (const char *name, int value, bool useShader = false);
@@ -41,9 +81,28 @@ public:
     void    SetVector4f (const char *name, float x, float y, float z, float w, bool useShader = false);
     void    SetVector4f (const char *name, const glm::vec4 &value, bool useShader = false);
     void    SetMatrix4  (const char *name, const glm::mat4 &matrix, bool useShader = false);
+    // utility functions taking a pre-resolved location from GetUniformLocation
+    void    SetFloat    (int location, float value, bool useShader = false);
+    void    SetInteger  (int location, int value, bool useShader = false);
+    void    SetVector2f (int location, const glm::vec2 &value, bool useShader = false);
+    void    SetVector3f (int location, const glm::vec3 &value, bool useShader = false);
+    void    SetVector4f (int location, const glm::vec4 &value, bool useShader = false);
+    void    SetMatrix4  (int location, const glm::mat4 &matrix, bool useShader = false);
 private:
-    // checks if compilation or linking failed and if so, print the error logs
-    void    checkCompileErrors(unsigned int object, std::string type); 
+    // active uniforms reflected after linking; shared by every copy of this shader
+    std::shared_ptr<UniformTable> uniforms;
+    // link state of the program; shared by every copy of this shader
+    std::shared_ptr<ProgramState> state;
+    // whether completion of submitted programs can be polled without blocking
+    static bool parallelCompile;
+    // uniform buffer backing the shared "Frame" block
+    static unsigned int frameUBO;
+    // reads the active uniforms of the linked program into the location table
+    void    reflectUniforms();
+    // resolves uniforms and attaches the "Frame" block once the program is linked
+    void    setupLinkedProgram();
+    // checks if compilation or linking failed and if so, print the error logs; returns whether it succeeded
+    bool    checkCompileErrors(unsigned int object, std::string type); 
 };
 
 #endif
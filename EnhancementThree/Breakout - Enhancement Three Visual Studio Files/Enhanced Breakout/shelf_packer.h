@@ -0,0 +1,45 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** ShelfPacker places rectangles into a fixed-width atlas row by row.
+******************************************************************/
+
+
+#ifndef SHELF_PACKER_H
+#define SHELF_PACKER_H
+
+#include <glm/glm.hpp>
+
+// ShelfPacker places rectangles left to right on horizontal shelves, starting
+// a new shelf when a rectangle does not fit on the current one. Every
+// rectangle is surrounded by the given padding. The atlas height is only
+// known once every rectangle has been added.
+class ShelfPacker
+{
+public:
+    ShelfPacker(int width, int padding);
+
+    // Returns whether a rectangle fits, with its padding, within the atlas width in both dimensions
+    bool Fits(int width, int height) const;
+
+    // Reserves space for a rectangle and returns its top-left corner
+    // The rectangle must fit (see Fits), or it would extend past the right edge of the atlas.
+    glm::ivec2 Add(int width, int height);
+
+    // Width of the atlas
+    int Width() const { return this->width; }
+
+    // Height needed to hold every rectangle added so far, including padding
+    int Height() const;
+
+private:
+    int width, padding;
+    int penX, penY, shelfHeight;
+};
+
+#endif
@@ -11,6 +11,8 @@
 #ifndef SPRITE_RENDERER_H
 #define SPRITE_RENDERER_H
 
+#include <vector>
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -18,30 +20,96 @@
 #include "texture.h"
 #include "shader.h"
 
+// Per-instance record used by the sprite batch. The first fields are streamed
+// to the GPU as instanced vertex attributes; TextureIndex selects the entry in
+// the batch's texture table and is used to group sprites into draw calls.
+struct SpriteInstance {
+    glm::vec2    Position;      // Top-left corner of the sprite
+    glm::vec2    Size;          // Width and height of the sprite
+    glm::vec4    Color;         // RGBA tint applied to the sprite
+    float        Rotation;      // Rotation around the sprite's center (in degrees)
+    glm::vec4    Region;        // UV offset and scale of the image within its texture
+    unsigned int TextureIndex;  // Index into the batch's texture table
+};
+
 // SpriteRenderer class handles rendering textured sprites
 class SpriteRenderer
 {
 public:
-    // Constructor: Initializes the shader for rendering
-    SpriteRenderer(Shader& shader);
+    // Constructor: Initializes the shaders used for immediate and batched rendering
+    SpriteRenderer(Shader& shader, Shader& batchShader);
 
     // Destructor: Cleans up any allocated OpenGL resources
     ~SpriteRenderer();
 
     // Renders a quad textured with the provided sprite
     // Takes parameters for position, size, rotation, and color
+    // While a batch is open the sprite is recorded instead of drawn immediately.
     void DrawSprite(Texture2D& texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
 
+    // Opens a batch; subsequent DrawSprite calls are recorded into the instance buffer
+    void Begin();
+
+    // Draws every recorded sprite with one instanced draw call per texture
+    // Sprites within a single flush should not overlap, since they are grouped by texture.
+    void Flush();
+
+    // Flushes the batch and returns to immediate rendering
+    void End();
+
+    // Returns whether a batch is currently open
+    bool IsBatching() const { return this->batching; }
+
+    // Creates a vertex array that reads sprite instances from an external buffer,
+    // starting at the given instance. The caller owns the returned vertex array.
+    unsigned int CreateInstanceArray(unsigned int buffer, size_t firstInstance);
+
+    // Draws the first count instances of a vertex array created by CreateInstanceArray
+    // Any sprites recorded in the open batch are flushed first to keep the draw order.
+    void DrawInstances(unsigned int vao, Texture2D& texture, size_t count);
+
 private:
-    // Shader used for rendering the sprite
+    // Shader used for rendering single sprites
     Shader       shader;
 
+    // Shader used for rendering batched sprite instances
+    Shader       batchShader;
+
+    // Pre-resolved uniform locations of the single sprite shader
+    int          modelLocation, colorLocation, regionLocation;
+
+    // Link revision of the single sprite shader the locations were resolved for
+    unsigned int shaderRevision = 0;
+
     // VAO (Vertex Array Object) for the sprite's quad
     unsigned int quadVAO;
 
+    // Quad vertex buffer, shared by the immediate and the instanced VAO
+    unsigned int quadVBO;
+
+    // Batch render state
+    unsigned int instanceVAO;
+    unsigned int instanceVBO;
+    size_t       instanceCapacity = 0;  // Number of instances the instance buffer can hold
+    bool         batching = false;
+
+    // Batch contents
+    std::vector<SpriteInstance> instances;       // Sprites recorded since the last flush
+    std::vector<SpriteInstance> sortedInstances; // Scratch buffer holding the instances grouped by texture
+    std::vector<Texture2D>      textures;        // Texture table referenced by SpriteInstance::TextureIndex
+    std::vector<unsigned int>   textureOffsets;  // Scratch buffer holding the first instance of each texture group
+
     // Initializes and configures the quad's buffer and vertex attributes for rendering
     void initRenderData();
+
+    // Resolves the uniform locations of the single sprite shader (again after it is reloaded)
+    void configureShader();
+
+    // Points the instanced vertex attributes at the given byte offset of the instance buffer
+    void setInstanceOffset(size_t offset);
+
+    // Returns the texture table index for a texture, adding it if needed
+    unsigned int textureIndex(const Texture2D& texture);
 };
 
 #endif
-
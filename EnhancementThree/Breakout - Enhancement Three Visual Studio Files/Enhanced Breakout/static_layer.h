@@ -0,0 +1,56 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** StaticLayer caches parts of the frame that do not change during
+** a level in an offscreen framebuffer.
+******************************************************************/
+
+
+#ifndef STATIC_LAYER_H
+#define STATIC_LAYER_H
+
+#include <glad/glad.h>
+
+// StaticLayer is a framebuffer with a color texture the size of the window.
+// Content rendered between Begin and End is tagged with a generation number
+// and the framebuffer size; IsCurrent reports whether it can be reused, and
+// Blit copies it into the default framebuffer.
+class StaticLayer
+{
+public:
+    StaticLayer() { }
+    ~StaticLayer();
+    StaticLayer(const StaticLayer&) = delete;
+    StaticLayer& operator=(const StaticLayer&) = delete;
+
+    // Returns whether the layer holds content for the given generation and size
+    bool IsCurrent(unsigned int generation, unsigned int width, unsigned int height) const;
+
+    // Redirects rendering into the layer, (re)allocating it for the given size
+    void Begin(unsigned int generation, unsigned int width, unsigned int height);
+
+    // Returns rendering to the default framebuffer
+    void End();
+
+    // Copies the layer over the whole default framebuffer
+    void Blit() const;
+
+    // Discards the cached content so the next IsCurrent check fails
+    void Invalidate() { this->valid = false; }
+
+private:
+    unsigned int fbo = 0, colorTexture = 0;
+    unsigned int width = 0, height = 0;
+    unsigned int generation = 0;
+    bool         valid = false;
+
+    // Creates or resizes the color attachment
+    void allocate(unsigned int width, unsigned int height);
+};
+
+#endif
@@ -10,7 +10,11 @@
 #ifndef TEXT_RENDERER_H
 #define TEXT_RENDERER_H
 
+#include <array>
+#include <cstdint>
 #include <map>
+#include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -18,33 +22,105 @@
 #include "texture.h"
 #include "shader.h"
 
+// Number of character codes (ASCII) loaded from the font
+const unsigned int GLYPH_COUNT = 128;
+
 // Holds all state information relevant to a character as loaded using FreeType
 struct Character {
-	unsigned int TextureID = 0;  // ID handle of the glyph texture
 	glm::ivec2   Size;           // Size of the glyph
 	glm::ivec2   Bearing;        // Offset from baseline to the left/top of the glyph
 	unsigned int Advance = 0;    // The horizontal offset to advance to the next glyph
+	glm::vec2    UVMin;          // Top-left texture coordinate of the glyph in the atlas
+	glm::vec2    UVMax;          // Bottom-right texture coordinate of the glyph in the atlas
+	bool         Loaded = false; // Whether the glyph was loaded from the font
+};
+
+// A font rasterized into an atlas image, not yet uploaded to the GPU.
+struct FontAtlas {
+	std::array<Character, GLYPH_COUNT> Characters;
+	std::vector<unsigned char>         Pixels;         // Single-channel atlas image, empty if the font failed to load
+	int                                Width = 0, Height = 0;
+};
+
+// Number of frames a cached text layout may go unused before it is released
+const unsigned int TEXT_LAYOUT_LIFETIME = 300;
+
+// Identifies a cached text layout: the string, its scale and the font it was laid out with.
+struct TextLayoutKey {
+	std::string  Text;
+	float        Scale;
+	unsigned int Font;
+};
+
+// Borrowed form of TextLayoutKey used for lookups, so finding a layout does not copy the string.
+struct TextLayoutKeyRef {
+	const std::string& Text;
+	float              Scale;
+	unsigned int       Font;
+};
+
+// Orders layout keys by font, scale and then text. Transparent so it can compare against TextLayoutKeyRef.
+struct TextLayoutKeyLess {
+	using is_transparent = void;
+
+	template <typename A, typename B>
+	bool operator()(const A& a, const B& b) const
+	{
+		if (a.Font != b.Font) return a.Font < b.Font;
+		if (a.Scale != b.Scale) return a.Scale < b.Scale;
+		return a.Text < b.Text;
+	}
+};
+
+// Positioned glyph quads of one string, kept in their own GPU buffer.
+// Quads are laid out relative to the text origin so the same layout can be drawn anywhere.
+struct TextLayout {
+	unsigned int  VAO = 0;
+	unsigned int  VBO = 0;
+	unsigned int  VertexCount = 0;
+	float         Width = 0.0f;      // Width of the laid out string in pixels
+	unsigned long LastUsedFrame = 0; // Frame in which the layout was last drawn or measured
 };
 
 
 // A renderer class for rendering text displayed by a font loaded using the 
 // FreeType library. A sinle font is loaded, processed into a list of character
-// items for later rendering.
+// items for later rendering. All glyphs are packed into a single atlas texture
+// so that a string is drawn with one draw call, and the laid out quads of each
+// string are cached so that repeated strings are not laid out again every frame.
 class TextRenderer
 {
 public:
-	// Holds a list of pre-compiled characters
-	std::map<char, Character> Characters;
+	// Holds the pre-compiled characters, indexed by character code
+	std::array<Character, GLYPH_COUNT> Characters;
+
+	// Texture holding every loaded glyph
+	unsigned int AtlasTexture = 0;
 
 	// Shader used for text rendering
 	Shader TextShader;
 
 	// Constructor
-	TextRenderer(unsigned int width, unsigned int height);
+	TextRenderer();
+
+	// Destructor: Releases the atlas and the cached layouts
+	~TextRenderer();
 
 	// Pre-compiles a list of characters from the given font
 	void Load(const std::string& font, unsigned int fontSize);
 
+	// Rasterizes a font into an atlas image without touching OpenGL, so it can run on a worker thread.
+	// The result is cached on disk; later calls for the same font file and size read the cache
+	// instead of starting FreeType.
+	static FontAtlas Rasterize(const std::string& font, unsigned int fontSize);
+
+	// Selects the directory glyph cache files are kept in (the working directory by default).
+	// Must be called before fonts are rasterized on worker threads.
+	static void SetCacheDirectory(const std::string& directory);
+
+	// Replaces the current font with a rasterized one, uploading its atlas
+	void Load(const FontAtlas& atlas);
+
 	// Renders a string of text using the pre-compiled list of characters
 	void RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
 
@@ -54,10 +130,37 @@ public:
 	// Creates a horizontally centered rendering for text
 	void RenderCenteredText(const std::string& text, float y, int width, float scale, glm::vec3 color = glm::vec3(1.0f));
 
+	// Advances the frame counter and releases layouts that have not been used for TEXT_LAYOUT_LIFETIME frames
+	void NewFrame();
 
 private:
-	// Render state
-	unsigned int VAO, VBO;
+	// Pre-resolved uniform locations of the text shader
+	int colorLocation, offsetLocation;
+	unsigned int shaderRevision = 0;   // Link revision of the text shader they were resolved for
+
+	// Layout cache state
+	std::map<TextLayoutKey, TextLayout, TextLayoutKeyLess> layouts;
+	unsigned long frame = 0;       // Current frame, used to age the cached layouts
+	unsigned int  font = 0;        // Incremented every time a font is loaded
+	std::vector<float> vertices;   // Scratch buffer for the quads of the string being laid out
+
+	// Returns the cached layout for a string, laying it out and uploading it on a miss
+	TextLayout& layout(const std::string& text, float scale);
+
+	// Releases the GPU buffers of every cached layout
+	void clearLayouts();
+
+	// Points the sampler at unit 0 and resolves the uniform locations (again after the shader is reloaded)
+	void configureShader();
+
+	// Returns the glyph for a character, or nullptr if the font does not provide it
+	const Character* glyph(char c) const;
+
+	// Reads a glyph cache file written for the given font contents and size
+	static bool readGlyphCache(const std::string& file, uint64_t fontHash, unsigned int fontSize, FontAtlas& atlas);
+
+	// Writes a rasterized font to a glyph cache file
+	static void writeGlyphCache(const std::string& file, uint64_t fontHash, unsigned int fontSize, const FontAtlas& atlas);
 };
 
 
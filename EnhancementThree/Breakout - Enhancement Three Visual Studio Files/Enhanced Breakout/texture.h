@@ -11,7 +11,16 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <vector>
+
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Pixels of one mip level, rows tightly packed
+struct TextureLevel {
+    unsigned int         Width, Height;
+    const unsigned char* Data;
+};
 
 // Texture2D class is responsible for managing OpenGL textures.
 // It stores texture data and provides functions for generating,
@@ -33,6 +42,10 @@ public:
     unsigned int Filter_Min;      // Filtering mode when texture is minified
     unsigned int Filter_Max;      // Filtering mode when texture is magnified
 
+    // Part of the GL texture holding this image: xy is the UV offset, zw the UV scale.
+    // Images packed into an atlas share the atlas ID and differ only in their region.
+    glm::vec4    Region;
+
     // Constructor that sets default texture configuration
     Texture2D();
 
@@ -41,7 +54,12 @@ public:
     // - width: The width of the texture in pixels
     // - height: The height of the texture in pixels
     // - data: Pointer to the texture's image data
-    void Generate(unsigned int width, unsigned int height, unsigned char* data);
+    void Generate(unsigned int width, unsigned int height, const unsigned char* data);
+
+    // Generates a texture from a complete mip chain, largest level first
+    // Parameters:
+    // - levels: The pixels of each level; Width and Height are taken from level 0
+    void Generate(const std::vector<TextureLevel>& levels);
 
     // Binds the texture as the currently active GL_TEXTURE_2D object
     void Bind() const;
@@ -0,0 +1,90 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** TileMapRenderer draws a whole brick grid as one quad, looking up
+** each tile's code in a small integer texture.
+******************************************************************/
+
+
+#ifndef TILE_MAP_RENDERER_H
+#define TILE_MAP_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "shader.h"
+
+// Number of tile colors the tile map shader can hold (tile codes 0-5)
+const unsigned int TILE_COLOR_COUNT = 6;
+
+// Tile codes of a level stored as a GL_R8UI texture, one texel per tile.
+// Owns its texture, so it cannot be copied.
+class TileMap
+{
+public:
+    unsigned int ID = 0;                   // OpenGL ID of the tile texture
+    unsigned int Columns = 0, Rows = 0;    // Size of the grid in tiles
+
+    TileMap() { }
+    ~TileMap();
+    TileMap(const TileMap&) = delete;
+    TileMap& operator=(const TileMap&) = delete;
+
+    // Uploads a row-major grid of tile codes
+    void Generate(unsigned int columns, unsigned int rows, const unsigned char* codes);
+
+    // Replaces the code of a single tile
+    void SetTile(unsigned int column, unsigned int row, unsigned char code);
+
+    // Replaces every tile code, keeping the texture's storage
+    void SetTiles(const unsigned char* codes);
+};
+
+// TileMapRenderer draws tile maps with the "tilemap" shader. Code 0 is empty,
+// code 1 uses the solid block texture and every other code uses the regular
+// block texture tinted with its palette color.
+class TileMapRenderer
+{
+public:
+    // Constructor: takes the tile map shader and the two block textures
+    TileMapRenderer(Shader& shader, Texture2D& block, Texture2D& solidBlock);
+
+    // Destructor: Cleans up the quad's buffers
+    ~TileMapRenderer();
+
+    // Sets the tint of each tile code; colors must hold TILE_COLOR_COUNT entries
+    void SetPalette(const glm::vec3* colors);
+
+    // Draws the tiles with codes in [firstCode, lastCode], stretched over the given rectangle
+    void Draw(const TileMap& tiles, glm::vec2 position, glm::vec2 size, unsigned int firstCode = 1, unsigned int lastCode = 255);
+
+private:
+    Shader       shader;
+    Texture2D    block, solidBlock;
+
+    // Pre-resolved uniform locations
+    int          originLocation, sizeLocation, paletteLocation, codeRangeLocation;
+
+    // Palette last set, kept to restore it when the shader is reloaded
+    glm::vec3    palette[TILE_COLOR_COUNT];
+
+    // Link revision of the shader the uniforms were set for
+    unsigned int shaderRevision = 0;
+
+    // Unit quad
+    unsigned int quadVAO, quadVBO;
+
+    // Initializes the unit quad's buffer and vertex attributes
+    void initRenderData();
+
+    // Points the samplers at their units and sets the persistent uniforms (again after the shader is reloaded)
+    void configureShader();
+};
+
+#endif
@@ -1,17 +1,23 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec2 offset; // Per-instance particle position
+layout (location = 2) in vec4 color;  // Per-instance particle color
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
-uniform mat4 projection;
-uniform vec2 offset;
-uniform vec4 color;
+// Per-frame values shared by every program
+layout (std140) uniform Frame
+{
+    mat4 projection;
+};
+
+uniform vec4 region;  // UV offset (xy) and scale (zw) of the particle image within its texture
 
 void main()
 {
 	float scale = 7.5f;
-	TexCoords = vertex.zw;
+	TexCoords = region.xy + vertex.zw * region.zw;
 	ParticleColor = color;
 	gl_Position = projection * vec4((vertex.xy * scale) + offset, 0.0, 1.0);
 }
\ No newline at end of file
@@ -4,10 +4,15 @@ layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 projection;
+uniform vec4 region;  // UV offset (xy) and scale (zw) of the image within its texture
+// Per-frame values shared by every program
+layout (std140) uniform Frame
+{
+    mat4 projection;
+};
 
 void main()
 {
-    TexCoords = vertex.zw;
+    TexCoords = region.xy + vertex.zw * region.zw;
     gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
 }
\ No newline at end of file
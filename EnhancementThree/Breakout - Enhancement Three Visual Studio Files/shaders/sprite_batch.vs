@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec2 instancePosition;
+layout (location = 2) in vec2 instanceSize;
+layout (location = 3) in vec4 instanceColor;
+layout (location = 4) in float instanceRotation;
+layout (location = 5) in vec4 instanceRegion;  // UV offset (xy) and scale (zw) within the texture
+
+out vec2 TexCoords;
+out vec4 SpriteColor;
+
+// Per-frame values shared by every program
+layout (std140) uniform Frame
+{
+    mat4 projection;
+};
+
+void main()
+{
+    // Scale the unit quad around its center, rotate it, then move it into place.
+    vec2 local = (vertex.xy - 0.5) * instanceSize;
+    float angle = radians(instanceRotation);
+    vec2 rotated = vec2(local.x * cos(angle) - local.y * sin(angle),
+                        local.x * sin(angle) + local.y * cos(angle));
+
+    TexCoords = instanceRegion.xy + vertex.zw * instanceRegion.zw;
+    SpriteColor = instanceColor;
+    gl_Position = projection * vec4(rotated + instancePosition + 0.5 * instanceSize, 0.0, 1.0);
+}
@@ -2,10 +2,15 @@
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
 out vec2 TexCoords;
 
-uniform mat4 projection;
+// Per-frame values shared by every program
+layout (std140) uniform Frame
+{
+    mat4 projection;
+};
+uniform vec2 offset; // Position of the text origin on screen
 
 void main()
 {
-	gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+	gl_Position = projection * vec4(vertex.xy + offset, 0.0, 1.0);
 	TexCoords = vertex.zw;
 }
@@ -0,0 +1,35 @@
+#version 330 core
+#define TILE_COLOR_COUNT 6  // Must match TILE_COLOR_COUNT in tile_map_renderer.h
+
+in vec2 TexCoords;
+out vec4 color;
+
+uniform usampler2D tiles;       // One tile code per texel
+uniform sampler2D block;
+uniform sampler2D blockSolid;
+uniform vec3 tileColors[TILE_COLOR_COUNT];  // Tint of each tile code
+uniform ivec2 codeRange;        // First and last tile code to draw
+uniform vec4 blockRegion;       // UV offset (xy) and scale (zw) of each block image within its texture
+uniform vec4 solidRegion;
+
+void main()
+{
+    // Find the tile under this fragment and where in the tile it lies.
+    ivec2 gridSize = textureSize(tiles, 0);
+    vec2 grid = TexCoords * vec2(gridSize);
+    ivec2 cell = min(ivec2(grid), gridSize - 1);
+    uint code = texelFetch(tiles, cell, 0).r;
+
+    // Take the derivatives before any fragment is discarded, and from the continuous grid
+    // position: fract() jumps at tile edges, which would select the coarsest mip level there.
+    vec2 gridDx = dFdx(grid);
+    vec2 gridDy = dFdy(grid);
+    if (code == 0u || int(code) < codeRange.x || int(code) > codeRange.y)
+        discard;
+
+    vec2 local = fract(grid);
+    vec4 texel = code == 1u ? textureGrad(blockSolid, solidRegion.xy + local * solidRegion.zw, gridDx * solidRegion.zw, gridDy * solidRegion.zw)
+                            : textureGrad(block, blockRegion.xy + local * blockRegion.zw, gridDx * blockRegion.zw, gridDy * blockRegion.zw);
+    vec3 tint = code < uint(TILE_COLOR_COUNT) ? tileColors[code] : vec3(1.0);
+    color = vec4(tint, 1.0) * texel;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+
+out vec2 TexCoords;
+
+// Per-frame values shared by every program
+layout (std140) uniform Frame
+{
+    mat4 projection;
+};
+
+uniform vec2 origin;  // Top-left corner of the brick field
+uniform vec2 size;    // Size of the brick field
+
+void main()
+{
+    TexCoords = vertex.zw;
+    gl_Position = projection * vec4(origin + vertex.xy * size, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** compile_level checks text levels (.lvl) and compiles them into the
+** binary level format (.blvl) that GameLevel::Parse reads directly.
+** Levels with ragged rows, stray characters, trailing spaces or tile
+** codes above 255 are rejected instead of compiled.
+**
+** Usage: compile_level <level.lvl>...
+**   e.g. compile_level ../levels/1.lvl ../levels/2.lvl
+**   writes ../levels/1.blvl next to ../levels/1.lvl, and so on
+**   (a shell wildcard over the levels directory compiles every level)
+**
+** Build (C++17): cl /EHsc /std:c++17 compile_level.cpp
+**            or: g++ -std=c++17 compile_level.cpp -o compile_level
+******************************************************************/
+
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../Enhanced Breakout/level_file.h"
+
+// A level read from text
+struct Level {
+    std::vector<unsigned char> Tiles;
+    uint32_t                   Columns = 0, Rows = 0;
+};
+
+// Parses a level strictly: each line holds tile codes separated by single spaces, every
+// line has the same number of codes, and only the final line break may be followed by nothing.
+// Returns an empty string on success, otherwise a description of the first problem.
+static std::string parseLevel(const std::string& text, Level& level)
+{
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string line = text.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        lines.push_back(line);
+        start = end + 1;
+    }
+    if (lines.empty())
+        return "the level is empty";
+
+    for (size_t y = 0; y < lines.size(); ++y)
+    {
+        const std::string& line = lines[y];
+        std::string where = "line " + std::to_string(y + 1) + ": ";
+        if (line.empty())
+            return where + "empty row";
+        if (line.front() == ' ')
+            return where + "leading space";
+        if (line.back() == ' ')
+            return where + "trailing space";
+
+        uint32_t columns = 0;
+        for (size_t x = 0; x < line.size(); )
+        {
+            if (line[x] < '0' || line[x] > '9')
+                return where + "unexpected character '" + line[x] + "' in column " + std::to_string(x + 1);
+            unsigned int code = 0;
+            while (x < line.size() && line[x] >= '0' && line[x] <= '9')
+            {
+                code = code * 10 + static_cast<unsigned int>(line[x] - '0');
+                if (code > 255)
+                    return where + "tile code above 255 in column " + std::to_string(x + 1);
+                ++x;
+            }
+            level.Tiles.push_back(static_cast<unsigned char>(code));
+            ++columns;
+            if (x < line.size())
+            {
+                if (line[x] != ' ')
+                    return where + "unexpected character '" + line[x] + "' in column " + std::to_string(x + 1);
+                if (x + 1 < line.size() && line[x + 1] == ' ')
+                    return where + "more than one space in column " + std::to_string(x + 1);
+                ++x;
+            }
+        }
+
+        if (y == 0)
+            level.Columns = columns;
+        else if (columns != level.Columns)
+            return where + std::to_string(columns) + " tiles, but line 1 has " + std::to_string(level.Columns);
+        ++level.Rows;
+    }
+    if (level.Columns > LEVEL_MAX_DIMENSION || level.Rows > LEVEL_MAX_DIMENSION)
+        return "the level is larger than " + std::to_string(LEVEL_MAX_DIMENSION) + " tiles in a direction";
+    return std::string();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: compile_level <level.lvl>..." << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string input = argv[i];
+        std::ifstream file(input, std::ios::binary);
+        if (!file)
+        {
+            std::cerr << input << ": cannot be read" << std::endl;
+            ++failures;
+            continue;
+        }
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        Level level;
+        std::string error = parseLevel(text, level);
+        if (!error.empty())
+        {
+            std::cerr << input << ": " << error << std::endl;
+            ++failures;
+            continue;
+        }
+
+        LevelFileHeader header;
+        std::memcpy(header.Magic, LEVEL_FILE_MAGIC, sizeof(LEVEL_FILE_MAGIC));
+        header.Version = LEVEL_FILE_VERSION;
+        header.Columns = level.Columns;
+        header.Rows = level.Rows;
+        header.Checksum = LevelChecksum(level.Tiles.data(), level.Tiles.size());
+        header.Reserved = 0;
+
+        std::string output = input.substr(0, input.find_last_of('.')) + LEVEL_FILE_EXTENSION;
+        std::ofstream compiled(output, std::ios::binary);
+        compiled.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        compiled.write(reinterpret_cast<const char*>(level.Tiles.data()), static_cast<std::streamsize>(level.Tiles.size()));
+        if (!compiled)
+        {
+            std::cerr << output << ": cannot be written" << std::endl;
+            ++failures;
+            continue;
+        }
+        std::cout << input << " -> " << output << " (" << level.Columns << "x" << level.Rows << ")" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
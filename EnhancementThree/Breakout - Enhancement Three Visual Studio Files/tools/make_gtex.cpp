@@ -0,0 +1,155 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** make_gtex converts an image into a pre-decoded texture file with
+** a full mip chain, optionally scaled down to the size it is drawn
+** at. ResourceManager loads it in place of the original image.
+**
+** Usage: make_gtex <input image> <output .gtex> [width height]
+**   e.g. make_gtex ../textures/background.jpg ../textures/background.gtex 800 600
+**
+** Build (C++17): cl /EHsc /std:c++17 make_gtex.cpp
+**            or: g++ -std=c++17 make_gtex.cpp -o make_gtex
+******************************************************************/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../Enhanced Breakout/stb_image.h"
+#include "../Enhanced Breakout/gpu_texture.h"
+
+// Pixels of one level, rows tightly packed
+struct Image {
+    int                        Width = 0, Height = 0;
+    std::vector<unsigned char> Pixels;
+};
+
+// Scales an image by averaging the source pixels that each target pixel covers.
+// Used both for the initial downscale and for every mip level.
+static Image resize(const Image& source, int width, int height, int channels)
+{
+    Image target;
+    target.Width = width;
+    target.Height = height;
+    target.Pixels.resize(static_cast<size_t>(width) * height * channels);
+    for (int y = 0; y < height; ++y)
+    {
+        int y0 = y * source.Height / height;
+        int y1 = std::max(y0 + 1, (y + 1) * source.Height / height);
+        for (int x = 0; x < width; ++x)
+        {
+            int x0 = x * source.Width / width;
+            int x1 = std::max(x0 + 1, (x + 1) * source.Width / width);
+            for (int c = 0; c < channels; ++c)
+            {
+                unsigned int sum = 0;
+                for (int sy = y0; sy < y1; ++sy)
+                    for (int sx = x0; sx < x1; ++sx)
+                        sum += source.Pixels[(static_cast<size_t>(sy) * source.Width + sx) * channels + c];
+                unsigned int count = static_cast<unsigned int>((y1 - y0) * (x1 - x0));
+                target.Pixels[(static_cast<size_t>(y) * width + x) * channels + c] = static_cast<unsigned char>((sum + count / 2) / count);
+            }
+        }
+    }
+    return target;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3 && argc != 5)
+    {
+        std::cerr << "Usage: make_gtex <input image> <output .gtex> [width height]" << std::endl;
+        return 1;
+    }
+
+    // Keep an alpha channel only if the image has one; the game uploads RGB or RGBA.
+    int width, height, fileChannels;
+    if (!stbi_info(argv[1], &width, &height, &fileChannels))
+    {
+        std::cerr << "Failed to read " << argv[1] << ": " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+    int channels = (fileChannels == 2 || fileChannels == 4) ? 4 : 3;
+    unsigned char* data = stbi_load(argv[1], &width, &height, &fileChannels, channels);
+    if (!data)
+    {
+        std::cerr << "Failed to decode " << argv[1] << ": " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+    Image image;
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.assign(data, data + static_cast<size_t>(width) * height * channels);
+    stbi_image_free(data);
+
+    // Scale down to the drawn size; images are never scaled up.
+    if (argc == 5)
+    {
+        int targetWidth = std::atoi(argv[3]), targetHeight = std::atoi(argv[4]);
+        if (targetWidth <= 0 || targetHeight <= 0)
+        {
+            std::cerr << "Invalid size " << argv[3] << "x" << argv[4] << std::endl;
+            return 1;
+        }
+        if (targetWidth < image.Width || targetHeight < image.Height)
+            image = resize(image, std::min(targetWidth, image.Width), std::min(targetHeight, image.Height), channels);
+    }
+
+    // Build the mip chain down to 1x1.
+    std::vector<Image> levels;
+    levels.push_back(image);
+    while ((levels.back().Width > 1 || levels.back().Height > 1) && levels.size() < GPU_TEXTURE_MAX_LEVELS)
+    {
+        const Image& previous = levels.back();
+        levels.push_back(resize(previous, std::max(1, previous.Width / 2), std::max(1, previous.Height / 2), channels));
+    }
+
+    GpuTextureHeader header;
+    std::memcpy(header.Magic, GPU_TEXTURE_MAGIC, sizeof(GPU_TEXTURE_MAGIC));
+    header.Version = GPU_TEXTURE_VERSION;
+    header.Channels = static_cast<uint32_t>(channels);
+    header.LevelCount = static_cast<uint32_t>(levels.size());
+
+    std::vector<GpuTextureLevel> table(levels.size());
+    uint64_t offset = sizeof(GpuTextureHeader) + levels.size() * sizeof(GpuTextureLevel);
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        table[i].Width = static_cast<uint32_t>(levels[i].Width);
+        table[i].Height = static_cast<uint32_t>(levels[i].Height);
+        table[i].Offset = offset;
+        table[i].Size = levels[i].Pixels.size();
+        offset += levels[i].Pixels.size();
+    }
+
+    std::ofstream output(argv[2], std::ios::binary);
+    if (!output)
+    {
+        std::cerr << "Failed to create " << argv[2] << std::endl;
+        return 1;
+    }
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(GpuTextureLevel));
+    for (const Image& level : levels)
+        output.write(reinterpret_cast<const char*>(level.Pixels.data()), static_cast<std::streamsize>(level.Pixels.size()));
+    if (!output)
+    {
+        std::cerr << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << argv[2] << ": " << image.Width << "x" << image.Height << ", " << channels << " channels, "
+        << levels.size() << " levels, " << offset << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+**
+** pack_assets bundles the game's shaders, textures, levels and fonts
+** into a single asset pack that ResourceManager can map at startup.
+**
+** Usage: pack_assets <asset root> <output pack>
+**   e.g. pack_assets .. breakout.pak (run from "Enhanced Breakout")
+**
+** Build (C++17): cl /EHsc /std:c++17 pack_assets.cpp
+**            or: g++ -std=c++17 pack_assets.cpp -o pack_assets
+******************************************************************/
+
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../Enhanced Breakout/asset_pack.h"
+
+namespace fs = std::filesystem;
+
+// Asset directories below the root that are packed
+const char* const ASSET_DIRECTORIES[] = { "shaders", "textures", "levels", "fonts" };
+
+// A file to be packed, with the name it gets in the pack
+struct PackFile {
+    std::string Name;
+    fs::path    Path;
+};
+
+// Pack names use forward slashes and lower case, matching ResourceManager::PackName.
+static std::string packName(const fs::path& relative)
+{
+    std::string name = relative.generic_string();
+    for (char& c : name)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return name;
+}
+
+// Number of padding bytes needed to align an offset
+static uint64_t padding(uint64_t offset)
+{
+    return (PACK_ALIGNMENT - offset % PACK_ALIGNMENT) % PACK_ALIGNMENT;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: pack_assets <asset root> <output pack>" << std::endl;
+        return 1;
+    }
+    fs::path root = argv[1];
+
+    // Collect every regular file of the asset directories.
+    std::vector<PackFile> files;
+    for (const char* directory : ASSET_DIRECTORIES)
+    {
+        fs::path path = root / directory;
+        if (!fs::is_directory(path))
+        {
+            std::cerr << "Skipping missing directory " << path << std::endl;
+            continue;
+        }
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(path))
+        {
+            if (!entry.is_regular_file())
+                continue;
+            PackFile file;
+            file.Name = packName(fs::relative(entry.path(), root));
+            file.Path = entry.path();
+            if (file.Name.size() >= PACK_NAME_LENGTH)
+            {
+                std::cerr << "Name too long for the pack: " << file.Name << std::endl;
+                return 1;
+            }
+            files.push_back(file);
+        }
+    }
+
+    // The game looks entries up with a binary search, so the index is sorted by name.
+    std::sort(files.begin(), files.end(), [](const PackFile& a, const PackFile& b) { return std::strcmp(a.Name.c_str(), b.Name.c_str()) < 0; });
+    for (size_t i = 1; i < files.size(); ++i)
+    {
+        if (files[i].Name == files[i - 1].Name)
+        {
+            std::cerr << "Two files map to the pack name " << files[i].Name << std::endl;
+            return 1;
+        }
+    }
+
+    // Read the files and lay out the data after the index.
+    std::vector<std::vector<char>> contents(files.size());
+    std::vector<PackEntry> entries(files.size());
+    uint64_t offset = sizeof(PackHeader) + files.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        std::ifstream input(files[i].Path, std::ios::binary);
+        if (!input)
+        {
+            std::cerr << "Failed to read " << files[i].Path << std::endl;
+            return 1;
+        }
+        contents[i].assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+
+        offset += padding(offset);
+        std::memset(&entries[i], 0, sizeof(PackEntry));
+        std::memcpy(entries[i].Name, files[i].Name.c_str(), files[i].Name.size());
+        entries[i].Offset = offset;
+        entries[i].Size = contents[i].size();
+        offset += contents[i].size() + 1;  // Trailing NUL
+    }
+
+    PackHeader header;
+    std::memcpy(header.Magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.Version = PACK_VERSION;
+    header.EntryCount = static_cast<uint32_t>(entries.size());
+    header.Reserved = 0;
+
+    // Write the header, the index and the aligned, NUL-terminated data.
+    std::ofstream output(argv[2], std::ios::binary);
+    if (!output)
+    {
+        std::cerr << "Failed to create " << argv[2] << std::endl;
+        return 1;
+    }
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PackEntry));
+    uint64_t written = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    const char zeros[PACK_ALIGNMENT] = { 0 };
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        output.write(zeros, static_cast<std::streamsize>(entries[i].Offset - written));
+        output.write(contents[i].data(), static_cast<std::streamsize>(contents[i].size()));
+        output.put('\0');
+        written = entries[i].Offset + contents[i].size() + 1;
+    }
+    if (!output)
+    {
+        std::cerr << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << files.size() << " files (" << written << " bytes) into " << argv[2] << std::endl;
+    return 0;
+}